@@ -0,0 +1,103 @@
+#ifndef SOLAIRE_APPROXIMATE_HPP
+#define SOLAIRE_APPROXIMATE_HPP
+
+//Copyright 2016 Adam G. Smith
+//
+//Licensed under the Apache License, Version 2.0 (the "License");
+//you may not use this file except in compliance with the License.
+//You may obtain a copy of the License at
+//
+//http ://www.apache.org/licenses/LICENSE-2.0
+//
+//Unless required by applicable law or agreed to in writing, software
+//distributed under the License is distributed on an "AS IS" BASIS,
+//WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//See the License for the specific language governing permissions and
+//limitations under the License.
+
+#include <cmath>
+#include <cstring>
+#include "solaire/maths/maths.hpp"
+#include "solaire/maths/instrument.hpp"
+
+#if defined(SOLAIRE_MATHS_SSE2)
+	#include <xmmintrin.h>
+#endif
+
+namespace solaire {
+
+	//! \brief Accuracy of reciprocal and reciprocal square root operations
+	enum precision : uint32_t {
+		PRECISION_EXACT,	//!< sqrt and divide
+		PRECISION_REFINED,	//!< Hardware estimate with one Newton-Raphson step, ~22 bits
+		PRECISION_ESTIMATE	//!< Hardware estimate only, ~12 bits
+	};
+}
+
+extern "C" SOLAIRE_EXPORT_API void SOLAIRE_EXPORT_CALL solaire_rsqrt(const float*, float*, const uint32_t, const solaire::precision);
+extern "C" SOLAIRE_EXPORT_API void SOLAIRE_EXPORT_CALL solaire_rcp(const float*, float*, const uint32_t, const solaire::precision);
+extern "C" SOLAIRE_EXPORT_API void SOLAIRE_EXPORT_CALL solaire_sqrt(const float*, float*, const uint32_t, const solaire::precision);
+
+namespace solaire {
+
+	template<const precision P>
+	inline float rsqrt(const float aValue) throw() {
+		if(P == PRECISION_EXACT) return 1.f / std::sqrt(aValue);
+		#if defined(SOLAIRE_MATHS_SSE2)
+			float y = _mm_cvtss_f32(_mm_rsqrt_ss(_mm_set_ss(aValue)));
+			if(P == PRECISION_REFINED) y = y * (1.5f - 0.5f * aValue * y * y);
+		#else
+			// No hardware estimate, start from the bit pattern and take an extra step
+			uint32_t bits;
+			std::memcpy(&bits, &aValue, sizeof(float));
+			bits = 0x5F375A86 - (bits >> 1);
+			float y;
+			std::memcpy(&y, &bits, sizeof(float));
+			y = y * (1.5f - 0.5f * aValue * y * y);
+			if(P == PRECISION_REFINED) y = y * (1.5f - 0.5f * aValue * y * y);
+		#endif
+		return y;
+	}
+
+	template<const precision P>
+	inline double rsqrt(const double aValue) throw() {
+		return 1.0 / std::sqrt(aValue);
+	}
+
+	template<const precision P>
+	inline float rcp(const float aValue) throw() {
+		if(P == PRECISION_EXACT) return 1.f / aValue;
+		#if defined(SOLAIRE_MATHS_SSE2)
+			float y = _mm_cvtss_f32(_mm_rcp_ss(_mm_set_ss(aValue)));
+			if(P == PRECISION_REFINED) y = y * (2.f - aValue * y);
+			return y;
+		#else
+			return 1.f / aValue;
+		#endif
+	}
+
+	template<const precision P>
+	inline double rcp(const double aValue) throw() {
+		return 1.0 / aValue;
+	}
+
+	template<const precision P>
+	inline void rsqrt_all(const float* const aInput, float* const aOutput, const uint32_t aCount) throw() {
+		SOLAIRE_INSTRUMENT(INSTRUMENT_VECTOR_BATCH, aCount);
+		solaire_rsqrt(aInput, aOutput, aCount, P);
+	}
+
+	template<const precision P>
+	inline void rcp_all(const float* const aInput, float* const aOutput, const uint32_t aCount) throw() {
+		SOLAIRE_INSTRUMENT(INSTRUMENT_VECTOR_BATCH, aCount);
+		solaire_rcp(aInput, aOutput, aCount, P);
+	}
+
+	template<const precision P>
+	inline void sqrt_all(const float* const aInput, float* const aOutput, const uint32_t aCount) throw() {
+		SOLAIRE_INSTRUMENT(INSTRUMENT_VECTOR_BATCH, aCount);
+		solaire_sqrt(aInput, aOutput, aCount, P);
+	}
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,195 @@
+#ifndef SOLAIRE_ARENA_HPP
+#define SOLAIRE_ARENA_HPP
+
+//Copyright 2016 Adam G. Smith
+//
+//Licensed under the Apache License, Version 2.0 (the "License");
+//you may not use this file except in compliance with the License.
+//You may obtain a copy of the License at
+//
+//http ://www.apache.org/licenses/LICENSE-2.0
+//
+//Unless required by applicable law or agreed to in writing, software
+//distributed under the License is distributed on an "AS IS" BASIS,
+//WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//See the License for the specific language governing permissions and
+//limitations under the License.
+
+#include <new>
+#include <vector>
+#include <type_traits>
+#include "solaire/maths/maths.hpp"
+
+namespace solaire {
+	class maths_arena;
+}
+
+extern "C" SOLAIRE_EXPORT_API solaire::maths_arena* SOLAIRE_EXPORT_CALL solaire_thread_arena();
+
+namespace solaire {
+
+	//! \brief Linear scratch allocator for maths temporaries
+	//! \detail Allocations are released all at once with rewind or reset. When a frame spills into
+	//! extra blocks, reset merges them into one block so the next frame runs without heap allocations
+	class maths_arena {
+	public:
+		enum {
+			DEFAULT_BLOCK_SIZE = 1 << 16,
+			DEFAULT_ALIGNMENT = 32
+		};
+
+		struct marker {
+			uint32_t block;
+			size_t offset;
+		};
+	private:
+		struct block {
+			uint8_t* data;
+			size_t size;
+		};
+
+		std::vector<block> mBlocks;
+		size_t mBlockSize;
+		size_t mOffset;
+		uint32_t mBlock;
+		uint32_t mHeapAllocations;
+	private:
+		maths_arena(const maths_arena&) = delete;
+		maths_arena& operator=(const maths_arena&) = delete;
+
+		void _release() throw() {
+			for(const block& i : mBlocks) ::operator delete(i.data);
+			mBlocks.clear();
+		}
+
+		void _push_block(const size_t aSize) {
+			block tmp;
+			tmp.data = static_cast<uint8_t*>(::operator new(aSize));
+			tmp.size = aSize;
+			mBlocks.push_back(tmp);
+			++mHeapAllocations;
+		}
+	public:
+		explicit maths_arena(const size_t aBlockSize = DEFAULT_BLOCK_SIZE) :
+			mBlockSize(aBlockSize),
+			mOffset(0),
+			mBlock(0),
+			mHeapAllocations(0)
+		{
+			mBlocks.reserve(8);
+		}
+
+		~maths_arena() {
+			_release();
+		}
+
+		//! \param aAlignment Must be a power of two
+		void* allocate(const size_t aBytes, const size_t aAlignment = DEFAULT_ALIGNMENT) {
+			while(mBlock < mBlocks.size()) {
+				const block& current = mBlocks[mBlock];
+				const uintptr_t address = reinterpret_cast<uintptr_t>(current.data) + mOffset;
+				const size_t offset = mOffset + (((address + aAlignment - 1) & ~static_cast<uintptr_t>(aAlignment - 1)) - address);
+				if(offset + aBytes <= current.size) {
+					mOffset = offset + aBytes;
+					return current.data + offset;
+				}
+				++mBlock;
+				mOffset = 0;
+			}
+
+			const size_t previous = mBlocks.empty() ? mBlockSize : mBlocks.back().size * 2;
+			const size_t required = aBytes + aAlignment;
+			_push_block(previous > required ? previous : required);
+			mBlock = static_cast<uint32_t>(mBlocks.size() - 1);
+			return allocate(aBytes, aAlignment);
+		}
+
+		//! \brief Default construct aCount objects, they are never destroyed so T must be trivially destructible
+		template<class T>
+		T* allocate(const uint32_t aCount) {
+			static_assert(std::is_trivially_destructible<T>::value, "solaire::maths_arena::allocate : Type must be trivially destructible");
+			T* const tmp = static_cast<T*>(allocate(sizeof(T) * aCount, alignof(T) > static_cast<size_t>(DEFAULT_ALIGNMENT) ? alignof(T) : static_cast<size_t>(DEFAULT_ALIGNMENT)));
+			for(uint32_t i = 0; i < aCount; ++i) new(tmp + i) T();
+			return tmp;
+		}
+
+		inline marker get_marker() const throw() {
+			marker tmp;
+			tmp.block = mBlock;
+			tmp.offset = mOffset;
+			return tmp;
+		}
+
+		inline void rewind(const marker aMarker) throw() {
+			mBlock = aMarker.block;
+			mOffset = aMarker.offset;
+		}
+
+		//! \brief Release every allocation, intended to be called once per frame
+		void reset() {
+			if(mBlocks.size() > 1) {
+				const size_t total = capacity();
+				_release();
+				_push_block(total);
+			}
+			mBlock = 0;
+			mOffset = 0;
+		}
+
+		size_t capacity() const throw() {
+			size_t tmp = 0;
+			for(const block& i : mBlocks) tmp += i.size;
+			return tmp;
+		}
+
+		size_t used() const throw() {
+			size_t tmp = mOffset;
+			for(uint32_t i = 0; i < mBlock && i < mBlocks.size(); ++i) tmp += mBlocks[i].size;
+			return tmp;
+		}
+
+		//! \brief Number of blocks requested from the heap over the arena's lifetime
+		inline uint32_t get_heap_allocations() const throw() {
+			return mHeapAllocations;
+		}
+	};
+
+	//! \brief Rewinds an arena to its state at construction when the scope exits
+	class arena_scope {
+	private:
+		maths_arena& mArena;
+		const maths_arena::marker mMarker;
+	private:
+		arena_scope(const arena_scope&) = delete;
+		arena_scope& operator=(const arena_scope&) = delete;
+	public:
+		explicit arena_scope(maths_arena& aArena) throw() :
+			mArena(aArena),
+			mMarker(aArena.get_marker())
+		{}
+
+		~arena_scope() {
+			mArena.rewind(mMarker);
+		}
+
+		template<class T>
+		inline T* allocate(const uint32_t aCount) {
+			return mArena.allocate<T>(aCount);
+		}
+
+		inline maths_arena& get_arena() const throw() {
+			return mArena;
+		}
+	};
+
+	//! \brief Arena owned by the calling thread, used by default for library temporaries
+	inline maths_arena& get_thread_arena() {
+		return *solaire_thread_arena();
+	}
+
+	inline void reset_thread_arena() {
+		get_thread_arena().reset();
+	}
+}
+
+#endif
@@ -0,0 +1,243 @@
+#ifndef SOLAIRE_BATCH_HPP
+#define SOLAIRE_BATCH_HPP
+
+//Copyright 2016 Adam G. Smith
+//
+//Licensed under the Apache License, Version 2.0 (the "License");
+//you may not use this file except in compliance with the License.
+//You may obtain a copy of the License at
+//
+//http ://www.apache.org/licenses/LICENSE-2.0
+//
+//Unless required by applicable law or agreed to in writing, software
+//distributed under the License is distributed on an "AS IS" BASIS,
+//WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//See the License for the specific language governing permissions and
+//limitations under the License.
+
+#include <algorithm>
+#include <cmath>
+#include "solaire/maths/vector.hpp"
+#include "solaire/maths/arena.hpp"
+#include "solaire/maths/parallel.hpp"
+#include "solaire/maths/instrument.hpp"
+
+extern "C" SOLAIRE_EXPORT_API void SOLAIRE_EXPORT_CALL solaire_distance_sq_tile(const float*, const float*, const uint32_t, const uint32_t, float*, const uint32_t);
+
+namespace solaire {
+
+	// Element-wise kernels over arrays of vectors. These are bound by memory bandwidth, so they are written
+	// as flat loops over the scalar components which the compiler vectorises, aOutput may alias any input.
+
+	enum : uint32_t {
+		DISTANCE_TILE = 256,			//!< Columns of a distance matrix kept in component form per pass
+		DISTANCE_PARALLEL_ROWS = 64		//!< Minimum distance matrix rows handed to a thread
+	};
+
+	template<class T, const uint32_t S>
+	void dot_all(const vector<T,S>* const aFirst, const vector<T,S>* const aSecond, T* const aOutput, const uint32_t aCount) throw() {
+		SOLAIRE_INSTRUMENT(INSTRUMENT_VECTOR_BATCH, aCount);
+		const T* const a = reinterpret_cast<const T*>(aFirst);
+		const T* const b = reinterpret_cast<const T*>(aSecond);
+		for(uint32_t i = 0; i < aCount; ++i) {
+			T tmp = a[i * S] * b[i * S];
+			for(uint32_t j = 1; j < S; ++j) tmp += a[i * S + j] * b[i * S + j];
+			aOutput[i] = tmp;
+		}
+	}
+
+	template<class T>
+	void cross_all(const vector<T,3>* const aFirst, const vector<T,3>* const aSecond, vector<T,3>* const aOutput, const uint32_t aCount) throw() {
+		SOLAIRE_INSTRUMENT(INSTRUMENT_VECTOR_BATCH, aCount);
+		const T* const a = reinterpret_cast<const T*>(aFirst);
+		const T* const b = reinterpret_cast<const T*>(aSecond);
+		T* const o = reinterpret_cast<T*>(aOutput);
+		for(uint32_t i = 0; i < aCount * 3; i += 3) {
+			const T ax = a[i], ay = a[i + 1], az = a[i + 2];
+			const T bx = b[i], by = b[i + 1], bz = b[i + 2];
+			o[i] = ay * bz - az * by;
+			o[i + 1] = az * bx - ax * bz;
+			o[i + 2] = ax * by - ay * bx;
+		}
+	}
+
+	template<class T, const uint32_t S>
+	void distance_sq_all(const vector<T,S>* const aFirst, const vector<T,S>* const aSecond, T* const aOutput, const uint32_t aCount) throw() {
+		SOLAIRE_INSTRUMENT(INSTRUMENT_VECTOR_BATCH, aCount);
+		const T* const a = reinterpret_cast<const T*>(aFirst);
+		const T* const b = reinterpret_cast<const T*>(aSecond);
+		for(uint32_t i = 0; i < aCount; ++i) {
+			T d = a[i * S] - b[i * S];
+			T tmp = d * d;
+			for(uint32_t j = 1; j < S; ++j) {
+				d = a[i * S + j] - b[i * S + j];
+				tmp += d * d;
+			}
+			aOutput[i] = tmp;
+		}
+	}
+
+	template<class T, const uint32_t S>
+	void distance_all(const vector<T,S>* const aFirst, const vector<T,S>* const aSecond, T* const aOutput, const uint32_t aCount) throw() {
+		distance_sq_all(aFirst, aSecond, aOutput, aCount);
+		for(uint32_t i = 0; i < aCount; ++i) aOutput[i] = static_cast<T>(std::sqrt(aOutput[i]));
+	}
+
+	template<const uint32_t S>
+	void distance_all(const vector<float,S>* const aFirst, const vector<float,S>* const aSecond, float* const aOutput, const uint32_t aCount) throw() {
+		distance_sq_all(aFirst, aSecond, aOutput, aCount);
+		solaire_sqrt(aOutput, aOutput, aCount, PRECISION_EXACT);
+	}
+
+	//! \brief aOutput[i] = aFirst[i] + (aSecond[i] - aFirst[i]) * aWeight
+	template<class T, const uint32_t S>
+	void lerp_all(const vector<T,S>* const aFirst, const vector<T,S>* const aSecond, const T aWeight, vector<T,S>* const aOutput, const uint32_t aCount) throw() {
+		SOLAIRE_INSTRUMENT(INSTRUMENT_VECTOR_BATCH, aCount);
+		const T* const a = reinterpret_cast<const T*>(aFirst);
+		const T* const b = reinterpret_cast<const T*>(aSecond);
+		T* const o = reinterpret_cast<T*>(aOutput);
+		for(uint32_t i = 0; i < aCount * S; ++i) o[i] = a[i] + (b[i] - a[i]) * aWeight;
+	}
+
+	//! \brief Interpolate with one weight per vector
+	template<class T, const uint32_t S>
+	void lerp_all(const vector<T,S>* const aFirst, const vector<T,S>* const aSecond, const T* const aWeights, vector<T,S>* const aOutput, const uint32_t aCount) throw() {
+		SOLAIRE_INSTRUMENT(INSTRUMENT_VECTOR_BATCH, aCount);
+		const T* const a = reinterpret_cast<const T*>(aFirst);
+		const T* const b = reinterpret_cast<const T*>(aSecond);
+		T* const o = reinterpret_cast<T*>(aOutput);
+		for(uint32_t i = 0; i < aCount; ++i) {
+			const T w = aWeights[i];
+			for(uint32_t j = i * S; j < i * S + S; ++j) o[j] = a[j] + (b[j] - a[j]) * w;
+		}
+	}
+
+	//! \brief aOutput[i] = aFirst[i] * aSecond[i] + aThird[i], contracted to fused multiply-add where the target supports it
+	template<class T, const uint32_t S>
+	void fma_all(const vector<T,S>* const aFirst, const vector<T,S>* const aSecond, const vector<T,S>* const aThird, vector<T,S>* const aOutput, const uint32_t aCount) throw() {
+		SOLAIRE_INSTRUMENT(INSTRUMENT_VECTOR_BATCH, aCount);
+		const T* const a = reinterpret_cast<const T*>(aFirst);
+		const T* const b = reinterpret_cast<const T*>(aSecond);
+		const T* const c = reinterpret_cast<const T*>(aThird);
+		T* const o = reinterpret_cast<T*>(aOutput);
+		for(uint32_t i = 0; i < aCount * S; ++i) o[i] = a[i] * b[i] + c[i];
+	}
+
+	template<class T, const uint32_t S>
+	void min_all(const vector<T,S>* const aFirst, const vector<T,S>* const aSecond, vector<T,S>* const aOutput, const uint32_t aCount) throw() {
+		SOLAIRE_INSTRUMENT(INSTRUMENT_VECTOR_BATCH, aCount);
+		const T* const a = reinterpret_cast<const T*>(aFirst);
+		const T* const b = reinterpret_cast<const T*>(aSecond);
+		T* const o = reinterpret_cast<T*>(aOutput);
+		for(uint32_t i = 0; i < aCount * S; ++i) o[i] = b[i] < a[i] ? b[i] : a[i];
+	}
+
+	template<class T, const uint32_t S>
+	void max_all(const vector<T,S>* const aFirst, const vector<T,S>* const aSecond, vector<T,S>* const aOutput, const uint32_t aCount) throw() {
+		SOLAIRE_INSTRUMENT(INSTRUMENT_VECTOR_BATCH, aCount);
+		const T* const a = reinterpret_cast<const T*>(aFirst);
+		const T* const b = reinterpret_cast<const T*>(aSecond);
+		T* const o = reinterpret_cast<T*>(aOutput);
+		for(uint32_t i = 0; i < aCount * S; ++i) o[i] = a[i] < b[i] ? b[i] : a[i];
+	}
+
+	//! \brief Clamp every vector component-wise to [aMin, aMax]
+	template<class T, const uint32_t S>
+	void clamp_all(const vector<T,S>* const aInput, const vector<T,S>& aMin, const vector<T,S>& aMax, vector<T,S>* const aOutput, const uint32_t aCount) throw() {
+		SOLAIRE_INSTRUMENT(INSTRUMENT_VECTOR_BATCH, aCount);
+		const T* const in = reinterpret_cast<const T*>(aInput);
+		T* const o = reinterpret_cast<T*>(aOutput);
+		T lower[S], upper[S];
+		for(uint32_t j = 0; j < S; ++j) {
+			lower[j] = aMin[j];
+			upper[j] = aMax[j];
+		}
+		for(uint32_t i = 0; i < aCount; ++i) {
+			for(uint32_t j = 0; j < S; ++j) {
+				const T tmp = in[i * S + j] < lower[j] ? lower[j] : in[i * S + j];
+				o[i * S + j] = upper[j] < tmp ? upper[j] : tmp;
+			}
+		}
+	}
+
+	//! \brief Reflect each vector about the matching normal, aNormals are expected to be unit length
+	template<class T, const uint32_t S>
+	void reflect_all(const vector<T,S>* const aInput, const vector<T,S>* const aNormals, vector<T,S>* const aOutput, const uint32_t aCount) throw() {
+		SOLAIRE_INSTRUMENT(INSTRUMENT_VECTOR_BATCH, aCount);
+		const T* const in = reinterpret_cast<const T*>(aInput);
+		const T* const n = reinterpret_cast<const T*>(aNormals);
+		T* const o = reinterpret_cast<T*>(aOutput);
+		for(uint32_t i = 0; i < aCount; ++i) {
+			T d = in[i * S] * n[i * S];
+			for(uint32_t j = 1; j < S; ++j) d += in[i * S + j] * n[i * S + j];
+			d += d;
+			for(uint32_t j = i * S; j < i * S + S; ++j) o[j] = in[j] - n[j] * d;
+		}
+	}
+
+	// Distance matrices
+
+	template<class T>
+	void _distance_sq_tile(const T* const aPoint, const T* const aComponents, const uint32_t aStride, const uint32_t aDimensions, T* const aOutput, const uint32_t aCount) throw() {
+		for(uint32_t j = 0; j < aCount; ++j) {
+			const T d = aComponents[j] - aPoint[0];
+			aOutput[j] = d * d;
+		}
+		for(uint32_t k = 1; k < aDimensions; ++k) {
+			const T* const component = aComponents + k * aStride;
+			for(uint32_t j = 0; j < aCount; ++j) {
+				const T d = component[j] - aPoint[k];
+				aOutput[j] += d * d;
+			}
+		}
+	}
+
+	inline void _distance_sq_tile(const float* const aPoint, const float* const aComponents, const uint32_t aStride, const uint32_t aDimensions, float* const aOutput, const uint32_t aCount) throw() {
+		solaire_distance_sq_tile(aPoint, aComponents, aStride, aDimensions, aOutput, aCount);
+	}
+
+	//! \brief Squared distance from every vector in aRows to every vector in aColumns
+	//! \detail aOutput is row major with aRowCount * aColumnCount elements. Columns are transposed to component arrays
+	//! DISTANCE_TILE at a time so one tile stays in cache while every row of a thread is compared against it.
+	template<class T, const uint32_t S>
+	void distance_matrix_sq(const vector<T,S>* const aRows, const uint32_t aRowCount, const vector<T,S>* const aColumns, const uint32_t aColumnCount, T* const aOutput) {
+		SOLAIRE_INSTRUMENT(INSTRUMENT_VECTOR_BATCH, static_cast<uint64_t>(aRowCount) * aColumnCount);
+		parallel_for(aRowCount, DISTANCE_PARALLEL_ROWS, [=](const uint32_t aBegin, const uint32_t aEnd) {
+			arena_scope scope(get_thread_arena());
+			T* const tile = scope.allocate<T>(S * DISTANCE_TILE);
+			for(uint32_t c = 0; c < aColumnCount; c += DISTANCE_TILE) {
+				const uint32_t count = aColumnCount - c < DISTANCE_TILE ? aColumnCount - c : static_cast<uint32_t>(DISTANCE_TILE);
+				const T* const columns = reinterpret_cast<const T*>(aColumns + c);
+				for(uint32_t j = 0; j < count; ++j) {
+					for(uint32_t k = 0; k < S; ++k) tile[k * DISTANCE_TILE + j] = columns[j * S + k];
+				}
+				for(uint32_t r = aBegin; r < aEnd; ++r) {
+					_distance_sq_tile(reinterpret_cast<const T*>(aRows + r), tile, DISTANCE_TILE, S, aOutput + static_cast<size_t>(r) * aColumnCount + c, count);
+				}
+			}
+		});
+	}
+
+	template<class T, const uint32_t S>
+	void distance_matrix(const vector<T,S>* const aRows, const uint32_t aRowCount, const vector<T,S>* const aColumns, const uint32_t aColumnCount, T* const aOutput) {
+		distance_matrix_sq(aRows, aRowCount, aColumns, aColumnCount, aOutput);
+		parallel_for(aRowCount, DISTANCE_PARALLEL_ROWS, [=](const uint32_t aBegin, const uint32_t aEnd) {
+			T* const row = aOutput + static_cast<size_t>(aBegin) * aColumnCount;
+			const size_t count = static_cast<size_t>(aEnd - aBegin) * aColumnCount;
+			for(size_t i = 0; i < count; ++i) row[i] = static_cast<T>(std::sqrt(row[i]));
+		});
+	}
+
+	template<const uint32_t S>
+	void distance_matrix(const vector<float,S>* const aRows, const uint32_t aRowCount, const vector<float,S>* const aColumns, const uint32_t aColumnCount, float* const aOutput) {
+		distance_matrix_sq(aRows, aRowCount, aColumns, aColumnCount, aOutput);
+		parallel_for(aRowCount, DISTANCE_PARALLEL_ROWS, [=](const uint32_t aBegin, const uint32_t aEnd) {
+			for(uint32_t r = aBegin; r < aEnd; ++r) {
+				float* const row = aOutput + static_cast<size_t>(r) * aColumnCount;
+				solaire_sqrt(row, row, aColumnCount, PRECISION_EXACT);
+			}
+		});
+	}
+}
+
+#endif
@@ -0,0 +1,436 @@
+#ifndef SOLAIRE_BVH_HPP
+#define SOLAIRE_BVH_HPP
+
+//Copyright 2016 Adam G. Smith
+//
+//Licensed under the Apache License, Version 2.0 (the "License");
+//you may not use this file except in compliance with the License.
+//You may obtain a copy of the License at
+//
+//http ://www.apache.org/licenses/LICENSE-2.0
+//
+//Unless required by applicable law or agreed to in writing, software
+//distributed under the License is distributed on an "AS IS" BASIS,
+//WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//See the License for the specific language governing permissions and
+//limitations under the License.
+
+#include <algorithm>
+#include <atomic>
+#include <limits>
+#include <vector>
+#include "solaire/maths/geometry.hpp"
+#include "solaire/maths/parallel.hpp"
+
+namespace solaire {
+
+	//! \brief Bounding volume hierarchy with N children per node
+	//! \detail Built with binned SAH, then collapsed into N-wide nodes stored in depth first order.
+	//! Child bounds are kept as an aabb_packet so each node visit is a single batched intersection test.
+	template<class T, const uint32_t S, const uint32_t N = 4>
+	class bvh {
+	public:
+		typedef T type;
+		typedef vector<T,S> point_t;
+		typedef aabb<T,S> bounds_t;
+		enum {
+			WIDTH = N,
+			LEAF_SIZE = 4,
+			BINS = 16,
+			MAX_SAH_DEPTH = 64,
+			PARALLEL_THRESHOLD = 4096,
+			INVALID = 0xFFFFFFFF
+		};
+
+		struct node {
+			aabb_packet<T,S,N> bounds;
+			uint32_t child[N];	//!< Node index, or first primitive slot when count[i] > 0, INVALID for an empty lane
+			uint32_t count[N];	//!< Primitive count of a leaf lane, 0 for an inner node lane
+		};
+	private:
+		struct build_node {
+			bounds_t bounds;
+			uint32_t left;
+			uint32_t right;
+			uint32_t begin;
+			uint32_t end;
+		};
+
+		struct build_primitive {
+			bounds_t bounds;
+			point_t centroid;
+			uint32_t index;
+		};
+
+		//! \brief A subtree left for the worker pool by the serial upper levels of a parallel build
+		struct build_task {
+			uint32_t* slot;	//!< Receives the subtree's root node
+			uint32_t begin;
+			uint32_t end;
+			uint32_t depth;
+		};
+
+		// Primitives are partitioned in place so each level of the build streams through contiguous memory
+		struct build_context {
+			std::vector<build_node> nodes;
+			std::vector<build_primitive> primitives;
+			std::vector<build_task>* tasks;	//!< While not null, subtrees at parallelDepth or below PARALLEL_THRESHOLD are queued instead of built
+			std::atomic<uint32_t> next;
+			uint32_t parallelDepth;
+		};
+
+		std::vector<node> mNodes;
+		std::vector<uint32_t> mIndices;
+		std::vector<bounds_t> mBounds;	//!< Primitive bounds in leaf order
+	private:
+		static bounds_t _lane_union(const aabb_packet<T,S,N>& aPacket) throw() {
+			bounds_t tmp;
+			for(uint32_t i = 0; i < N; ++i) tmp.merge(aPacket.get(i));
+			return tmp;
+		}
+
+		void _build(build_context& aContext, const uint32_t aBegin, const uint32_t aEnd, const uint32_t aDepth, uint32_t& aSlot) {
+			const uint32_t count = aEnd - aBegin;
+			if(aContext.tasks && (aDepth >= aContext.parallelDepth || count <= PARALLEL_THRESHOLD)) {
+				const build_task task = {&aSlot, aBegin, aEnd, aDepth};
+				aContext.tasks->push_back(task);
+				return;
+			}
+
+			const uint32_t index = aContext.next++;
+			aSlot = index;
+			bounds_t bounds;
+			bounds_t centroidBounds;
+			build_primitive* const first = aContext.primitives.data() + aBegin;
+			build_primitive* const last = aContext.primitives.data() + aEnd;
+			for(const build_primitive* i = first; i != last; ++i) {
+				bounds.merge(i->bounds);
+				centroidBounds.merge(i->centroid);
+			}
+
+			build_node& n = aContext.nodes[index];
+			n.bounds = bounds;
+			n.begin = aBegin;
+			n.end = aEnd;
+			n.left = INVALID;
+			n.right = INVALID;
+			if(count <= LEAF_SIZE) return;
+
+			build_primitive* middle = nullptr;
+
+			// Binned SAH over every axis, binned in a single pass over the primitives
+			uint32_t bestAxis = S;
+			uint32_t bestBin = 0;
+			T bestCost = std::numeric_limits<T>::max();
+			if(aDepth < MAX_SAH_DEPTH) {
+				T scales[S];
+				for(uint32_t axis = 0; axis < S; ++axis) {
+					const T extent = centroidBounds.upper[axis] - centroidBounds.lower[axis];
+					scales[axis] = extent > static_cast<T>(0) ? static_cast<T>(BINS) / extent : static_cast<T>(0);
+				}
+
+				bounds_t binBounds[S][BINS];
+				uint32_t binCounts[S][BINS];
+				for(uint32_t axis = 0; axis < S; ++axis) {
+					for(uint32_t i = 0; i < BINS; ++i) binCounts[axis][i] = 0;
+				}
+				for(const build_primitive* i = first; i != last; ++i) {
+					for(uint32_t axis = 0; axis < S; ++axis) {
+						uint32_t bin = static_cast<uint32_t>((i->centroid[axis] - centroidBounds.lower[axis]) * scales[axis]);
+						if(bin >= BINS) bin = BINS - 1;
+						binBounds[axis][bin].merge(i->bounds);
+						++binCounts[axis][bin];
+					}
+				}
+
+				for(uint32_t axis = 0; axis < S; ++axis) {
+					if(scales[axis] == static_cast<T>(0)) continue;
+
+					T rightCosts[BINS];
+					bounds_t accumulated;
+					uint32_t accumulatedCount = 0;
+					for(uint32_t i = BINS - 1; i > 0; --i) {
+						accumulated.merge(binBounds[axis][i]);
+						accumulatedCount += binCounts[axis][i];
+						rightCosts[i] = accumulatedCount == 0 ? static_cast<T>(0) : accumulated.surface_area() * static_cast<T>(accumulatedCount);
+					}
+
+					accumulated = bounds_t();
+					accumulatedCount = 0;
+					for(uint32_t i = 0; i < BINS - 1; ++i) {
+						accumulated.merge(binBounds[axis][i]);
+						accumulatedCount += binCounts[axis][i];
+						if(accumulatedCount == 0 || accumulatedCount == count) continue;
+						const T cost = accumulated.surface_area() * static_cast<T>(accumulatedCount) + rightCosts[i + 1];
+						if(cost < bestCost) {
+							bestCost = cost;
+							bestAxis = axis;
+							bestBin = i;
+						}
+					}
+				}
+			}
+
+			if(bestAxis < S) {
+				const T lower = centroidBounds.lower[bestAxis];
+				const T scale = static_cast<T>(BINS) / (centroidBounds.upper[bestAxis] - lower);
+				middle = std::partition(first, last, [&](const build_primitive& aPrimitive) {
+					uint32_t bin = static_cast<uint32_t>((aPrimitive.centroid[bestAxis] - lower) * scale);
+					if(bin >= BINS) bin = BINS - 1;
+					return bin <= bestBin;
+				});
+			}
+
+			if(middle == nullptr || middle == first || middle == last) {
+				// Degenerate centroids or too deep, split at the median of the longest axis
+				uint32_t axis = 0;
+				for(uint32_t i = 1; i < S; ++i) {
+					if(centroidBounds.upper[i] - centroidBounds.lower[i] > centroidBounds.upper[axis] - centroidBounds.lower[axis]) axis = i;
+				}
+				middle = first + count / 2;
+				std::nth_element(first, middle, last, [&](const build_primitive& a, const build_primitive& b) {
+					return a.centroid[axis] < b.centroid[axis];
+				});
+			}
+
+			const uint32_t split = static_cast<uint32_t>(middle - aContext.primitives.data());
+			_build(aContext, aBegin, split, aDepth + 1, n.left);
+			_build(aContext, split, aEnd, aDepth + 1, n.right);
+		}
+
+		uint32_t _flatten(const std::vector<build_node>& aNodes, const uint32_t aIndex) {
+			const uint32_t index = static_cast<uint32_t>(mNodes.size());
+			mNodes.push_back(node());
+
+			// Open the largest inner children until the node is full
+			uint32_t children[N];
+			uint32_t count = 0;
+			if(aNodes[aIndex].left == INVALID) {
+				children[count++] = aIndex;
+			}else {
+				children[count++] = aNodes[aIndex].left;
+				children[count++] = aNodes[aIndex].right;
+			}
+			while(count < N) {
+				uint32_t best = N;
+				T bestArea = static_cast<T>(-1);
+				for(uint32_t i = 0; i < count; ++i) {
+					const build_node& child = aNodes[children[i]];
+					if(child.left == INVALID) continue;
+					const T area = child.bounds.surface_area();
+					if(area > bestArea) {
+						bestArea = area;
+						best = i;
+					}
+				}
+				if(best == N) break;
+				const build_node& opened = aNodes[children[best]];
+				children[best] = opened.left;
+				children[count++] = opened.right;
+			}
+
+			for(uint32_t i = 0; i < N; ++i) {
+				if(i < count) {
+					const build_node& child = aNodes[children[i]];
+					mNodes[index].bounds.set(i, child.bounds);
+					if(child.left == INVALID) {
+						mNodes[index].child[i] = child.begin;
+						mNodes[index].count[i] = child.end - child.begin;
+					}else {
+						const uint32_t tmp = _flatten(aNodes, children[i]);
+						mNodes[index].child[i] = tmp;
+						mNodes[index].count[i] = 0;
+					}
+				}else {
+					mNodes[index].bounds.set(i, bounds_t());
+					mNodes[index].child[i] = INVALID;
+					mNodes[index].count[i] = 0;
+				}
+			}
+			return index;
+		}
+
+		template<class F>
+		bool _raycast(const ray<T,S>& aRay, T& aDistance, const F& aIntersect) const {
+			if(mNodes.empty()) return false;
+			uint32_t stack[(MAX_SAH_DEPTH + 64) * N];
+			uint32_t stackSize = 0;
+			stack[stackSize++] = 0;
+			bool hit = false;
+
+			while(stackSize > 0) {
+				const node& n = mNodes[stack[--stackSize]];
+				T distances[N];
+				const vector_mask<N> mask = intersects(aRay, n.bounds, aDistance, distances);
+				if(mask.none()) continue;
+
+				// Leaves are tested immediately to shrink aDistance, inner nodes are pushed far to near
+				uint32_t inner[N];
+				uint32_t innerCount = 0;
+				for(uint32_t i = 0; i < N; ++i) {
+					if(! mask[i] || n.child[i] == INVALID || distances[i] > aDistance) continue;
+					if(n.count[i] > 0) {
+						const uint32_t end = n.child[i] + n.count[i];
+						for(uint32_t j = n.child[i]; j < end; ++j) if(aIntersect(j, aDistance)) hit = true;
+					}else {
+						uint32_t k = innerCount++;
+						while(k > 0 && distances[inner[k - 1]] < distances[i]) {
+							inner[k] = inner[k - 1];
+							--k;
+						}
+						inner[k] = i;
+					}
+				}
+				for(uint32_t i = 0; i < innerCount; ++i) stack[stackSize++] = n.child[inner[i]];
+			}
+			return hit;
+		}
+	public:
+		bvh() {}
+
+		void build(const bounds_t* const aBounds, const uint32_t aCount) {
+			mNodes.clear();
+			mIndices.resize(aCount);
+			mBounds.resize(aCount);
+			if(aCount == 0) return;
+
+			build_context context;
+			context.nodes.resize(aCount * 2);
+			context.primitives.resize(aCount);
+			context.next = 0;
+			context.parallelDepth = 0;
+			for(uint32_t i = get_thread_count(); i > 1; i >>= 1) ++context.parallelDepth;
+
+			for(uint32_t i = 0; i < aCount; ++i) {
+				build_primitive& p = context.primitives[i];
+				p.bounds = aBounds[i];
+				p.centroid = aBounds[i].centre();
+				p.index = i;
+			}
+
+			// The upper levels are split on this thread, the subtrees below them are built on the worker pool
+			uint32_t root;
+			std::vector<build_task> tasks;
+			context.tasks = context.parallelDepth > 0 ? &tasks : nullptr;
+			_build(context, 0, aCount, 0, root);
+			context.tasks = nullptr;
+			parallel_for(static_cast<uint32_t>(tasks.size()), 1, [&](const uint32_t aBegin, const uint32_t aEnd) {
+				for(uint32_t i = aBegin; i < aEnd; ++i) _build(context, tasks[i].begin, tasks[i].end, tasks[i].depth, *tasks[i].slot);
+			});
+			mNodes.reserve(context.next);
+			_flatten(context.nodes, 0);
+			for(uint32_t i = 0; i < aCount; ++i) {
+				mIndices[i] = context.primitives[i].index;
+				mBounds[i] = context.primitives[i].bounds;
+			}
+		}
+
+		void build(const point_t* const aPoints, const uint32_t aCount) {
+			std::vector<bounds_t> bounds(aCount);
+			for(uint32_t i = 0; i < aCount; ++i) bounds[i] = bounds_t(aPoints[i], aPoints[i]);
+			build(bounds.data(), aCount);
+		}
+
+		//! \brief Update the node bounds for moved primitives without changing the tree topology
+		//! \detail aBounds is indexed by primitive and must have the same count as the last build
+		void refit(const bounds_t* const aBounds) {
+			const uint32_t count = static_cast<uint32_t>(mIndices.size());
+			for(uint32_t i = 0; i < count; ++i) mBounds[i] = aBounds[mIndices[i]];
+
+			// Children are always stored after their parent, so a reverse sweep visits them first
+			for(uint32_t i = static_cast<uint32_t>(mNodes.size()); i > 0; --i) {
+				node& n = mNodes[i - 1];
+				for(uint32_t j = 0; j < N; ++j) {
+					if(n.child[j] == INVALID) continue;
+					if(n.count[j] > 0) {
+						bounds_t tmp;
+						const uint32_t end = n.child[j] + n.count[j];
+						for(uint32_t k = n.child[j]; k < end; ++k) tmp.merge(mBounds[k]);
+						n.bounds.set(j, tmp);
+					}else {
+						n.bounds.set(j, _lane_union(mNodes[n.child[j]].bounds));
+					}
+				}
+			}
+		}
+
+		void refit(const point_t* const aPoints) {
+			std::vector<bounds_t> bounds(mIndices.size());
+			for(uint32_t i = 0; i < bounds.size(); ++i) bounds[i] = bounds_t(aPoints[i], aPoints[i]);
+			refit(bounds.data());
+		}
+
+		//! \brief Find the nearest primitive hit by aRay
+		//! \param aDistance Maximum distance on input, distance of the nearest hit on output
+		//! \param aIntersect bool(uint32_t aPrimitive, T& aDistance), returns true and shrinks aDistance on a closer hit
+		template<class F>
+		bool raycast(const ray<T,S>& aRay, T& aDistance, const F& aIntersect) const {
+			return _raycast(aRay, aDistance, [&](const uint32_t aSlot, T& aCurrent)->bool {
+				return aIntersect(mIndices[aSlot], aCurrent);
+			});
+		}
+
+		//! \brief Find the nearest primitive bounding box hit by aRay
+		bool raycast(const ray<T,S>& aRay, T& aDistance, uint32_t& aPrimitive) const {
+			return _raycast(aRay, aDistance, [&](const uint32_t aSlot, T& aCurrent)->bool {
+				T tNear = static_cast<T>(0);
+				T tFar = aCurrent;
+				if(! aRay.intersects(mBounds[aSlot], tNear, tFar) || tNear >= aCurrent) return false;
+				aCurrent = tNear;
+				aPrimitive = mIndices[aSlot];
+				return true;
+			});
+		}
+
+		//! \brief Append every primitive whose bounds overlap aBox to aResults
+		void query(const bounds_t& aBox, std::vector<uint32_t>& aResults) const {
+			if(mNodes.empty()) return;
+			std::vector<uint32_t> stack(1, 0);
+			while(! stack.empty()) {
+				const node& n = mNodes[stack.back()];
+				stack.pop_back();
+				for(uint32_t i = 0; i < N; ++i) {
+					if(n.child[i] == INVALID || ! aBox.intersects(n.bounds.get(i))) continue;
+					if(n.count[i] > 0) {
+						const uint32_t end = n.child[i] + n.count[i];
+						for(uint32_t j = n.child[i]; j < end; ++j) if(aBox.intersects(mBounds[j])) aResults.push_back(mIndices[j]);
+					}else {
+						stack.push_back(n.child[i]);
+					}
+				}
+			}
+		}
+
+		//! \brief Append every primitive whose bounds overlap aSphere to aResults
+		void query(const sphere<T,S>& aSphere, std::vector<uint32_t>& aResults) const {
+			if(mNodes.empty()) return;
+			std::vector<uint32_t> stack(1, 0);
+			while(! stack.empty()) {
+				const node& n = mNodes[stack.back()];
+				stack.pop_back();
+				for(uint32_t i = 0; i < N; ++i) {
+					if(n.child[i] == INVALID || ! aSphere.intersects(n.bounds.get(i))) continue;
+					if(n.count[i] > 0) {
+						const uint32_t end = n.child[i] + n.count[i];
+						for(uint32_t j = n.child[i]; j < end; ++j) if(aSphere.intersects(mBounds[j])) aResults.push_back(mIndices[j]);
+					}else {
+						stack.push_back(n.child[i]);
+					}
+				}
+			}
+		}
+
+		inline const std::vector<node>& get_nodes() const throw() {
+			return mNodes;
+		}
+
+		inline uint32_t size() const throw() {
+			return static_cast<uint32_t>(mIndices.size());
+		}
+	};
+
+	typedef bvh<float, 3, 4> bvh4_3f;
+	typedef bvh<float, 3, 8> bvh8_3f;
+}
+
+#endif
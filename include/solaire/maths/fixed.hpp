@@ -0,0 +1,172 @@
+#ifndef SOLAIRE_FIXED_HPP
+#define SOLAIRE_FIXED_HPP
+
+//Copyright 2016 Adam G. Smith
+//
+//Licensed under the Apache License, Version 2.0 (the "License");
+//you may not use this file except in compliance with the License.
+//You may obtain a copy of the License at
+//
+//http ://www.apache.org/licenses/LICENSE-2.0
+//
+//Unless required by applicable law or agreed to in writing, software
+//distributed under the License is distributed on an "AS IS" BASIS,
+//WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//See the License for the specific language governing permissions and
+//limitations under the License.
+
+#include <cmath>
+#include "solaire/maths/maths.hpp"
+#include "solaire/maths/instrument.hpp"
+
+extern "C" SOLAIRE_EXPORT_API void SOLAIRE_EXPORT_CALL solaire_fixed32_to_float(const int32_t*, float*, const uint32_t, const uint32_t);
+extern "C" SOLAIRE_EXPORT_API void SOLAIRE_EXPORT_CALL solaire_float_to_fixed32(const float*, int32_t*, const uint32_t, const uint32_t);
+
+namespace solaire {
+
+	//! \brief Signed fixed point number with I integer bits (including sign) and F fractional bits
+	template<const uint32_t I, const uint32_t F>
+	class fixed {
+	public:
+		typedef typename std::conditional<I + F <= 16, int16_t, int32_t>::type type;
+		typedef typename std::conditional<I + F <= 16, int32_t, int64_t>::type wide_t;
+		enum {
+			INTEGER_BITS = I,
+			FRACTION_BITS = F
+		};
+	private:
+		static_assert(I + F <= 32, "solaire::fixed : Total bit count must be 32 or less");
+		static_assert(I > 0, "solaire::fixed : Must have at least one integer bit");
+
+		static SOLAIRE_CONSTEXPR_I11 wide_t one() throw() {
+			return static_cast<wide_t>(1) << F;
+		}
+
+		type mValue;
+	public:
+		SOLAIRE_CONSTEXPR_11 fixed() throw() :
+			mValue(0)
+		{}
+
+		template<class T2, typename ENABLE = typename std::enable_if<std::is_arithmetic<T2>::value>::type>
+		fixed(const T2 aValue) throw() :
+			mValue(std::is_floating_point<T2>::value ?
+				static_cast<type>(std::lrint(static_cast<double>(aValue) * static_cast<double>(one()))) :
+				static_cast<type>(static_cast<wide_t>(aValue) * one())
+			)
+		{}
+
+		static SOLAIRE_CONSTEXPR_I11 fixed<I,F> from_raw(const type aValue) throw() {
+			return fixed<I,F>(aValue, 0);
+		}
+
+		SOLAIRE_CONSTEXPR_I11 type get_raw() const throw() {
+			return mValue;
+		}
+
+		template<class T2, typename ENABLE = typename std::enable_if<std::is_arithmetic<T2>::value>::type>
+		SOLAIRE_CONSTEXPR_I11 explicit operator T2() const throw() {
+			return std::is_floating_point<T2>::value ?
+				static_cast<T2>(mValue) / static_cast<T2>(one()) :
+				static_cast<T2>(mValue / one());
+		}
+
+		SOLAIRE_CONSTEXPR_I14 fixed<I,F>& operator+=(const fixed<I,F> aOther) throw() {
+			mValue += aOther.mValue;
+			return *this;
+		}
+
+		SOLAIRE_CONSTEXPR_I14 fixed<I,F>& operator-=(const fixed<I,F> aOther) throw() {
+			mValue -= aOther.mValue;
+			return *this;
+		}
+
+		SOLAIRE_CONSTEXPR_I14 fixed<I,F>& operator*=(const fixed<I,F> aOther) throw() {
+			mValue = static_cast<type>((static_cast<wide_t>(mValue) * aOther.mValue) >> F);
+			return *this;
+		}
+
+		SOLAIRE_CONSTEXPR_I14 fixed<I,F>& operator/=(const fixed<I,F> aOther) throw() {
+			mValue = static_cast<type>((static_cast<wide_t>(mValue) * one()) / aOther.mValue);
+			return *this;
+		}
+
+		SOLAIRE_CONSTEXPR_I14 fixed<I,F> operator+(const fixed<I,F> aOther) const throw() {
+			return fixed<I,F>(*this) += aOther;
+		}
+
+		SOLAIRE_CONSTEXPR_I14 fixed<I,F> operator-(const fixed<I,F> aOther) const throw() {
+			return fixed<I,F>(*this) -= aOther;
+		}
+
+		SOLAIRE_CONSTEXPR_I14 fixed<I,F> operator*(const fixed<I,F> aOther) const throw() {
+			return fixed<I,F>(*this) *= aOther;
+		}
+
+		SOLAIRE_CONSTEXPR_I14 fixed<I,F> operator/(const fixed<I,F> aOther) const throw() {
+			return fixed<I,F>(*this) /= aOther;
+		}
+
+		SOLAIRE_CONSTEXPR_I11 fixed<I,F> operator-() const throw() {
+			return fixed<I,F>(static_cast<type>(-mValue), 0);
+		}
+
+		SOLAIRE_CONSTEXPR_I11 bool operator==(const fixed<I,F> aOther) const throw() {
+			return mValue == aOther.mValue;
+		}
+
+		SOLAIRE_CONSTEXPR_I11 bool operator!=(const fixed<I,F> aOther) const throw() {
+			return mValue != aOther.mValue;
+		}
+
+		SOLAIRE_CONSTEXPR_I11 bool operator<(const fixed<I,F> aOther) const throw() {
+			return mValue < aOther.mValue;
+		}
+
+		SOLAIRE_CONSTEXPR_I11 bool operator>(const fixed<I,F> aOther) const throw() {
+			return mValue > aOther.mValue;
+		}
+
+		SOLAIRE_CONSTEXPR_I11 bool operator<=(const fixed<I,F> aOther) const throw() {
+			return mValue <= aOther.mValue;
+		}
+
+		SOLAIRE_CONSTEXPR_I11 bool operator>=(const fixed<I,F> aOther) const throw() {
+			return mValue >= aOther.mValue;
+		}
+	private:
+		SOLAIRE_CONSTEXPR_11 fixed(const type aValue, int) throw() :
+			mValue(aValue)
+		{}
+	};
+
+	typedef fixed<16, 16> fixed_16_16;
+	typedef fixed<8, 8> fixed_8_8;
+
+	template<const uint32_t I, const uint32_t F>
+	inline void convert(const fixed<I,F>* const aInput, float* const aOutput, const uint32_t aCount) throw() {
+		SOLAIRE_INSTRUMENT(INSTRUMENT_VECTOR_BATCH, aCount);
+		if(sizeof(fixed<I,F>) == sizeof(int32_t)) {
+			solaire_fixed32_to_float(reinterpret_cast<const int32_t*>(aInput), aOutput, aCount, F);
+		}else {
+			for(uint32_t i = 0; i < aCount; ++i) aOutput[i] = static_cast<float>(aInput[i]);
+		}
+	}
+
+	template<const uint32_t I, const uint32_t F>
+	inline void convert(const float* const aInput, fixed<I,F>* const aOutput, const uint32_t aCount) throw() {
+		SOLAIRE_INSTRUMENT(INSTRUMENT_VECTOR_BATCH, aCount);
+		if(sizeof(fixed<I,F>) == sizeof(int32_t)) {
+			solaire_float_to_fixed32(aInput, reinterpret_cast<int32_t*>(aOutput), aCount, F);
+		}else {
+			for(uint32_t i = 0; i < aCount; ++i) aOutput[i] = fixed<I,F>(aInput[i]);
+		}
+	}
+
+	template<const uint32_t I, const uint32_t F>
+	std::ostream& operator<<(std::ostream& aStream, const fixed<I,F> aValue) {
+		return aStream << static_cast<double>(aValue);
+	}
+}
+
+#endif
\ No newline at end of file
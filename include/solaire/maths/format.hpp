@@ -0,0 +1,410 @@
+#ifndef SOLAIRE_FORMAT_HPP
+#define SOLAIRE_FORMAT_HPP
+
+//Copyright 2016 Adam G. Smith
+//
+//Licensed under the Apache License, Version 2.0 (the "License");
+//you may not use this file except in compliance with the License.
+//You may obtain a copy of the License at
+//
+//http ://www.apache.org/licenses/LICENSE-2.0
+//
+//Unless required by applicable law or agreed to in writing, software
+//distributed under the License is distributed on an "AS IS" BASIS,
+//WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//See the License for the specific language governing permissions and
+//limitations under the License.
+
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <clocale>
+#include <cstring>
+#include <limits>
+#include <string>
+#include "solaire/maths/matrix.hpp"
+#include "solaire/maths/parallel.hpp"
+
+#if defined(__has_include) && (__cplusplus >= 201703L || (defined(_MSVC_LANG) && _MSVC_LANG >= 201703L))
+	#if __has_include(<charconv>)
+		#include <charconv>
+		#if defined(__cpp_lib_to_chars)
+			#define SOLAIRE_MATHS_CHARCONV
+		#endif
+	#endif
+#endif
+
+namespace solaire {
+
+	enum {
+		FORMAT_MAX_SCALAR = 32	//!< Longest text produced for one scalar
+	};
+
+	// Scalars
+
+	inline bool _is_number_text(const char aChar) throw() {
+		return (aChar >= '0' && aChar <= '9') || (aChar >= 'a' && aChar <= 'z') || (aChar >= 'A' && aChar <= 'Z') || aChar == '-' || aChar == '+';
+	}
+
+	//! \brief Write the shortest text that parses back to the same value
+	//! \detail Without <charconv> floating point values use the fewest %g digits that round trip
+	//! \return One past the last character written, or nullptr if the buffer is too small
+	template<class T, typename ENABLE = typename std::enable_if<std::is_arithmetic<T>::value && ! std::is_same<T, bool>::value>::type>
+	char* to_chars(char* const aFirst, char* const aLast, const T aValue) throw() {
+		#if defined(SOLAIRE_MATHS_CHARCONV)
+			const std::to_chars_result result = std::to_chars(aFirst, aLast, aValue);
+			return result.ec == std::errc() ? result.ptr : nullptr;
+		#else
+			char tmp[FORMAT_MAX_SCALAR];
+			int length;
+			if(std::is_floating_point<T>::value) {
+				// Fewest significant digits that parse back to the same value
+				const bool single = sizeof(T) <= sizeof(float);
+				const double value = static_cast<double>(aValue);
+				int precision = single ? 6 : 15;
+				const int maxPrecision = single ? 9 : 17;
+				while(true) {
+					length = std::snprintf(tmp, FORMAT_MAX_SCALAR, "%.*g", precision, value);
+					if(precision == maxPrecision || length < 0 || value != value) break;
+					if(single ? std::strtof(tmp, nullptr) == static_cast<float>(value) : std::strtod(tmp, nullptr) == value) break;
+					++precision;
+				}
+			}else if(std::is_signed<T>::value) {
+				length = std::snprintf(tmp, FORMAT_MAX_SCALAR, "%lld", static_cast<long long>(aValue));
+			}else {
+				length = std::snprintf(tmp, FORMAT_MAX_SCALAR, "%llu", static_cast<unsigned long long>(aValue));
+			}
+			if(length < 0 || length >= FORMAT_MAX_SCALAR) return nullptr;
+
+			// snprintf writes the C locale's decimal point, which may not be '.' or a single character
+			char* end = aFirst;
+			bool point = false;
+			for(int i = 0; i < length; ++i) {
+				const bool text = _is_number_text(tmp[i]);
+				if(! text && point) continue;
+				if(end == aLast) return nullptr;
+				*(end++) = text ? tmp[i] : '.';
+				point = ! text;
+			}
+			return end;
+		#endif
+	}
+
+	inline char* to_chars(char* const aFirst, char* const aLast, const bool aValue) throw() {
+		if(aFirst == aLast) return nullptr;
+		*aFirst = aValue ? '1' : '0';
+		return aFirst + 1;
+	}
+
+	inline char* to_chars(char* const aFirst, char* const aLast, const half aValue) throw() {
+		return to_chars(aFirst, aLast, static_cast<float>(aValue));
+	}
+
+	template<const uint32_t I, const uint32_t F>
+	inline char* to_chars(char* const aFirst, char* const aLast, const fixed<I,F> aValue) throw() {
+		return to_chars(aFirst, aLast, static_cast<double>(aValue));
+	}
+
+	inline const char* _skip_space(const char* aFirst, const char* const aLast) throw() {
+		while(aFirst != aLast && (*aFirst == ' ' || *aFirst == '\t' || *aFirst == '\r')) ++aFirst;
+		return aFirst;
+	}
+
+	// strto* for each floating point type, parsing straight to float avoids rounding twice
+	inline float _strtof(const char* const aString, char** const aEnd, const float) throw() {
+		return std::strtof(aString, aEnd);
+	}
+
+	inline double _strtof(const char* const aString, char** const aEnd, const double) throw() {
+		return std::strtod(aString, aEnd);
+	}
+
+	inline long double _strtof(const char* const aString, char** const aEnd, const long double) throw() {
+		return std::strtold(aString, aEnd);
+	}
+
+	//! \brief Parse a scalar, leading spaces and a leading '+' are skipped
+	//! \return One past the last character consumed, or nullptr if no value could be read or it is out of range for T
+	template<class T, typename ENABLE = typename std::enable_if<std::is_arithmetic<T>::value && ! std::is_same<T, bool>::value>::type>
+	const char* from_chars(const char* aFirst, const char* const aLast, T& aValue) throw() {
+		aFirst = _skip_space(aFirst, aLast);
+		if(aFirst != aLast && *aFirst == '+') ++aFirst;
+		#if defined(SOLAIRE_MATHS_CHARCONV)
+			const std::from_chars_result result = std::from_chars(aFirst, aLast, aValue);
+			return result.ec == std::errc() ? result.ptr : nullptr;
+		#else
+			// strto* needs a terminated copy of the token
+			char tmp[FORMAT_MAX_SCALAR * 2];
+			uint32_t length = 0;
+			while(aFirst + length != aLast && length + 1 < sizeof(tmp)) {
+				const char c = aFirst[length];
+				if(! ((c >= '0' && c <= '9') || c == '-' || c == '+' || c == '.' || c == 'e' || c == 'E' || c == 'x' || c == 'X' || (c >= 'a' && c <= 'f') || (c >= 'A' && c <= 'F') || c == 'n' || c == 'N' || c == 'i' || c == 'I')) break;
+				tmp[length++] = c;
+			}
+			tmp[length] = '\0';
+			char* end;
+			errno = 0;
+			if(std::is_floating_point<T>::value) {
+				// strtod expects the C locale's decimal point, swap it in for '.' and map the end back
+				const char* const point = std::localeconv()->decimal_point;
+				const size_t pointLength = std::strlen(point);
+				char local[FORMAT_MAX_SCALAR * 2 * 4];
+				size_t localLength = 0;
+				for(uint32_t i = 0; i < length && localLength + pointLength < sizeof(local); ++i) {
+					if(tmp[i] == '.') {
+						std::memcpy(local + localLength, point, pointLength);
+						localLength += pointLength;
+					}else {
+						local[localLength++] = tmp[i];
+					}
+				}
+				local[localLength] = '\0';
+				typedef typename std::conditional<std::is_floating_point<T>::value, T, double>::type float_t;
+				const float_t value = _strtof(local, &end, float_t());
+				// ERANGE is also set for subnormal results, only overflow and underflow to zero are out of range
+				if(end == local || (errno == ERANGE && (value == static_cast<float_t>(0) || value - value != static_cast<float_t>(0)))) return nullptr;
+				size_t consumed = 0;
+				for(size_t i = 0; local + i < end; ++consumed) i += tmp[consumed] == '.' ? pointLength : 1;
+				aValue = static_cast<T>(value);
+				return aFirst + consumed;
+			}else if(std::is_signed<T>::value) {
+				const long long value = std::strtoll(tmp, &end, 10);
+				if(end == tmp || errno == ERANGE) return nullptr;
+				if(value < static_cast<long long>(std::numeric_limits<T>::min()) || value > static_cast<long long>(std::numeric_limits<T>::max())) return nullptr;
+				aValue = static_cast<T>(value);
+			}else {
+				// strtoull negates a leading '-' instead of rejecting it
+				if(tmp[0] == '-') return nullptr;
+				const unsigned long long value = std::strtoull(tmp, &end, 10);
+				if(end == tmp || errno == ERANGE) return nullptr;
+				if(value > static_cast<unsigned long long>(std::numeric_limits<T>::max())) return nullptr;
+				aValue = static_cast<T>(value);
+			}
+			return aFirst + (end - tmp);
+		#endif
+	}
+
+	inline const char* from_chars(const char* aFirst, const char* const aLast, bool& aValue) throw() {
+		aFirst = _skip_space(aFirst, aLast);
+		if(aFirst == aLast || (*aFirst != '0' && *aFirst != '1')) return nullptr;
+		aValue = *aFirst == '1';
+		return aFirst + 1;
+	}
+
+	inline const char* from_chars(const char* const aFirst, const char* const aLast, half& aValue) throw() {
+		float tmp;
+		const char* const end = from_chars(aFirst, aLast, tmp);
+		if(end) aValue = half(tmp);
+		return end;
+	}
+
+	template<const uint32_t I, const uint32_t F>
+	inline const char* from_chars(const char* const aFirst, const char* const aLast, fixed<I,F>& aValue) throw() {
+		double tmp;
+		const char* const end = from_chars(aFirst, aLast, tmp);
+		if(end) aValue = fixed<I,F>(tmp);
+		return end;
+	}
+
+	// Vectors and matrices, written as [a,b,c] and [[a,b],[c,d]] to match operator<<
+
+	template<class T>
+	char* _format_sequence(char* aFirst, char* const aLast, const T* const aValues, const uint32_t aCount, const char aSeparator) throw() {
+		for(uint32_t i = 0; i < aCount; ++i) {
+			if(i > 0) {
+				if(aFirst == aLast) return nullptr;
+				*(aFirst++) = aSeparator;
+			}
+			aFirst = to_chars(aFirst, aLast, aValues[i]);
+			if(! aFirst) return nullptr;
+		}
+		return aFirst;
+	}
+
+	inline char* _put(char* const aFirst, char* const aLast, const char aChar) throw() {
+		if(aFirst == nullptr || aFirst == aLast) return nullptr;
+		*aFirst = aChar;
+		return aFirst + 1;
+	}
+
+	template<class T, const uint32_t S>
+	char* to_chars(char* aFirst, char* const aLast, const vector<T,S>& aValue) throw() {
+		aFirst = _put(aFirst, aLast, '[');
+		if(aFirst) aFirst = _format_sequence(aFirst, aLast, reinterpret_cast<const T*>(&aValue), S, ',');
+		return _put(aFirst, aLast, ']');
+	}
+
+	template<class T, const uint32_t W, const uint32_t H>
+	char* to_chars(char* aFirst, char* const aLast, const matrix<T,W,H>& aValue) throw() {
+		aFirst = _put(aFirst, aLast, '[');
+		for(uint32_t i = 0; i < H && aFirst; ++i) {
+			if(i > 0) aFirst = _put(aFirst, aLast, ',');
+			aFirst = _put(aFirst, aLast, '[');
+			if(aFirst) aFirst = _format_sequence(aFirst, aLast, aValue[i], W, ',');
+			aFirst = _put(aFirst, aLast, ']');
+		}
+		return _put(aFirst, aLast, ']');
+	}
+
+	//! \brief Read aCount values separated by commas and/or spaces
+	template<class T>
+	const char* _parse_sequence(const char* aFirst, const char* const aLast, T* const aValues, const uint32_t aCount) throw() {
+		for(uint32_t i = 0; i < aCount; ++i) {
+			if(i > 0) {
+				aFirst = _skip_space(aFirst, aLast);
+				if(aFirst != aLast && *aFirst == ',') ++aFirst;
+			}
+			aFirst = from_chars(aFirst, aLast, aValues[i]);
+			if(! aFirst) return nullptr;
+		}
+		return aFirst;
+	}
+
+	inline const char* _expect(const char* aFirst, const char* const aLast, const char aChar) throw() {
+		if(aFirst == nullptr) return nullptr;
+		aFirst = _skip_space(aFirst, aLast);
+		return aFirst != aLast && *aFirst == aChar ? aFirst + 1 : nullptr;
+	}
+
+	//! \brief Parse "[a,b,c]" or a bare "a, b, c" / "a b c"
+	template<class T, const uint32_t S>
+	const char* from_chars(const char* aFirst, const char* const aLast, vector<T,S>& aValue) throw() {
+		aFirst = _skip_space(aFirst, aLast);
+		const bool bracketed = aFirst != aLast && *aFirst == '[';
+		if(bracketed) ++aFirst;
+		aFirst = _parse_sequence(aFirst, aLast, &aValue[0], S);
+		return bracketed ? _expect(aFirst, aLast, ']') : aFirst;
+	}
+
+	//! \brief Parse "[[a,b],[c,d]]" or W * H bare values in row order
+	template<class T, const uint32_t W, const uint32_t H>
+	const char* from_chars(const char* aFirst, const char* const aLast, matrix<T,W,H>& aValue) throw() {
+		aFirst = _skip_space(aFirst, aLast);
+		if(aFirst == aLast || *aFirst != '[') {
+			for(uint32_t i = 0; i < H && aFirst; ++i) {
+				if(i > 0) {
+					aFirst = _skip_space(aFirst, aLast);
+					if(aFirst != aLast && *aFirst == ',') ++aFirst;
+				}
+				aFirst = _parse_sequence(aFirst, aLast, aValue[i], W);
+			}
+			return aFirst;
+		}
+		++aFirst;
+		for(uint32_t i = 0; i < H && aFirst; ++i) {
+			if(i > 0) aFirst = _expect(aFirst, aLast, ',');
+			aFirst = _expect(aFirst, aLast, '[');
+			if(aFirst) aFirst = _parse_sequence(aFirst, aLast, aValue[i], W);
+			aFirst = _expect(aFirst, aLast, ']');
+		}
+		return _expect(aFirst, aLast, ']');
+	}
+
+	// Bulk rows, one element per line
+
+	enum {
+		FORMAT_CHUNK = 1 << 16,			//!< Rows are formatted into a stack buffer of this size before being appended
+		FORMAT_PARALLEL_ROWS = 1 << 14	//!< Rows per thread task when formatting large arrays
+	};
+
+	template<class T>
+	void _append_block(std::string& aOutput, const T* const aValues, const uint32_t aRows, const uint32_t aColumns, const char aSeparator) {
+		const uint32_t rowLength = aColumns * (FORMAT_MAX_SCALAR + 1);
+		aOutput.reserve(aOutput.size() + static_cast<size_t>(aRows) * aColumns * 12);
+
+		char chunk[FORMAT_CHUNK];
+		char* const chunkEnd = chunk + FORMAT_CHUNK;
+		char* end = chunk;
+		for(uint32_t i = 0; i < aRows; ++i) {
+			if(static_cast<uint32_t>(chunkEnd - end) < rowLength) {
+				aOutput.append(chunk, end);
+				end = chunk;
+			}
+			if(rowLength > FORMAT_CHUNK) {
+				// Rows too long for the chunk are formatted directly into the string
+				const size_t offset = aOutput.size();
+				aOutput.resize(offset + rowLength);
+				char* const first = &aOutput[offset];
+				char* const last = _format_sequence(first, first + rowLength, aValues + static_cast<size_t>(i) * aColumns, aColumns, aSeparator);
+				*last = '\n';
+				aOutput.resize(offset + (last - first) + 1);
+			}else {
+				end = _format_sequence(end, chunkEnd, aValues + static_cast<size_t>(i) * aColumns, aColumns, aSeparator);
+				*(end++) = '\n';
+			}
+		}
+		aOutput.append(chunk, end);
+	}
+
+	template<class T>
+	void _append_rows(std::string& aOutput, const T* const aValues, const uint32_t aRows, const uint32_t aColumns, const char aSeparator) {
+		if(aRows <= FORMAT_PARALLEL_ROWS) {
+			_append_block(aOutput, aValues, aRows, aColumns, aSeparator);
+			return;
+		}
+
+		// Format fixed blocks independently then join them in order
+		const uint32_t blocks = (aRows + FORMAT_PARALLEL_ROWS - 1) / FORMAT_PARALLEL_ROWS;
+		std::vector<std::string> parts(blocks);
+		parallel_for(blocks, 1, [&](const uint32_t aBegin, const uint32_t aEnd) {
+			for(uint32_t i = aBegin; i < aEnd; ++i) {
+				const uint32_t first = i * FORMAT_PARALLEL_ROWS;
+				const uint32_t count = aRows - first < FORMAT_PARALLEL_ROWS ? aRows - first : static_cast<uint32_t>(FORMAT_PARALLEL_ROWS);
+				_append_block(parts[i], aValues + static_cast<size_t>(first) * aColumns, count, aColumns, aSeparator);
+			}
+		});
+
+		size_t length = aOutput.size();
+		for(const std::string& i : parts) length += i.size();
+		aOutput.reserve(length);
+		for(const std::string& i : parts) aOutput += i;
+	}
+
+	//! \brief Append one line per vector with components separated by aSeparator, for CSV use ','
+	template<class T, const uint32_t S>
+	void append_rows(std::string& aOutput, const vector<T,S>* const aData, const uint32_t aCount, const char aSeparator = ',') {
+		_append_rows(aOutput, reinterpret_cast<const T*>(aData), aCount, S, aSeparator);
+	}
+
+	//! \brief Append one line per matrix with all elements in row order
+	template<class T, const uint32_t W, const uint32_t H>
+	void append_rows(std::string& aOutput, const matrix<T,W,H>* const aData, const uint32_t aCount, const char aSeparator = ',') {
+		_append_rows(aOutput, reinterpret_cast<const T*>(aData), aCount, W * H, aSeparator);
+	}
+
+	template<class E>
+	uint32_t _parse_rows(const char* aFirst, const char* const aLast, E* const aOutput, const uint32_t aCount, const char** const aEnd) throw() {
+		uint32_t count = 0;
+		while(count < aCount) {
+			// Skip blank lines
+			while(aFirst != aLast && (*aFirst == '\n' || *aFirst == '\r' || *aFirst == ' ' || *aFirst == '\t')) ++aFirst;
+			if(aFirst == aLast) break;
+
+			const char* const end = from_chars(aFirst, aLast, aOutput[count]);
+			if(! end) break;
+			aFirst = _skip_space(end, aLast);
+			if(aFirst != aLast) {
+				if(*aFirst != '\n') break;
+				++aFirst;
+			}
+			++count;
+		}
+		if(aEnd) *aEnd = aFirst;
+		return count;
+	}
+
+	//! \brief Parse up to aCount lines of comma and/or whitespace separated components
+	//! \param aEnd If not null, receives where parsing stopped, which is a malformed line if it is not aLast
+	//! \return The number of vectors read
+	template<class T, const uint32_t S>
+	uint32_t parse_rows(const char* const aFirst, const char* const aLast, vector<T,S>* const aOutput, const uint32_t aCount, const char** const aEnd = nullptr) throw() {
+		return _parse_rows(aFirst, aLast, aOutput, aCount, aEnd);
+	}
+
+	template<class T, const uint32_t W, const uint32_t H>
+	uint32_t parse_rows(const char* const aFirst, const char* const aLast, matrix<T,W,H>* const aOutput, const uint32_t aCount, const char** const aEnd = nullptr) throw() {
+		return _parse_rows(aFirst, aLast, aOutput, aCount, aEnd);
+	}
+}
+
+#endif
@@ -0,0 +1,537 @@
+#ifndef SOLAIRE_GEOMETRY_HPP
+#define SOLAIRE_GEOMETRY_HPP
+
+//Copyright 2016 Adam G. Smith
+//
+//Licensed under the Apache License, Version 2.0 (the "License");
+//you may not use this file except in compliance with the License.
+//You may obtain a copy of the License at
+//
+//http ://www.apache.org/licenses/LICENSE-2.0
+//
+//Unless required by applicable law or agreed to in writing, software
+//distributed under the License is distributed on an "AS IS" BASIS,
+//WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//See the License for the specific language governing permissions and
+//limitations under the License.
+
+#include <limits>
+#include "solaire/maths/matrix.hpp"
+
+#if defined(SOLAIRE_MATHS_SSE2)
+	#include <emmintrin.h>
+#endif
+
+namespace solaire {
+
+	template<class T, const uint32_t S>
+	class aabb {
+	public:
+		typedef T type;
+		typedef vector<T,S> point_t;
+		enum{DIMENSIONS = S};
+	public:
+		point_t lower;
+		point_t upper;
+	public:
+		//! \brief An empty box, merging anything into it gives that thing's bounds
+		aabb() :
+			lower(std::numeric_limits<T>::max()),
+			upper(std::numeric_limits<T>::lowest())
+		{}
+
+		aabb(const point_t& aLower, const point_t& aUpper) :
+			lower(aLower),
+			upper(aUpper)
+		{}
+
+		inline bool empty() const throw() {
+			for(uint32_t i = 0; i < S; ++i) if(lower[i] > upper[i]) return true;
+			return false;
+		}
+
+		inline point_t centre() const throw() {
+			return (lower + upper) * static_cast<T>(0.5);
+		}
+
+		inline point_t extents() const throw() {
+			return upper - lower;
+		}
+
+		T surface_area() const throw() {
+			const point_t e = extents();
+			if(S == 2) return static_cast<T>(2) * (e[0] + e[1]);
+			T area = static_cast<T>(0);
+			for(uint32_t i = 0; i < S; ++i) {
+				for(uint32_t j = i + 1; j < S; ++j) area += e[i] * e[j];
+			}
+			return static_cast<T>(2) * area;
+		}
+
+		bool contains(const point_t& aPoint) const throw() {
+			for(uint32_t i = 0; i < S; ++i) if(aPoint[i] < lower[i] || aPoint[i] > upper[i]) return false;
+			return true;
+		}
+
+		bool intersects(const aabb<T,S>& aOther) const throw() {
+			for(uint32_t i = 0; i < S; ++i) if(aOther.upper[i] < lower[i] || aOther.lower[i] > upper[i]) return false;
+			return true;
+		}
+
+		aabb<T,S>& merge(const point_t& aPoint) throw() {
+			for(uint32_t i = 0; i < S; ++i) {
+				lower[i] = aPoint[i] < lower[i] ? aPoint[i] : lower[i];
+				upper[i] = aPoint[i] > upper[i] ? aPoint[i] : upper[i];
+			}
+			return *this;
+		}
+
+		aabb<T,S>& merge(const aabb<T,S>& aOther) throw() {
+			for(uint32_t i = 0; i < S; ++i) {
+				lower[i] = aOther.lower[i] < lower[i] ? aOther.lower[i] : lower[i];
+				upper[i] = aOther.upper[i] > upper[i] ? aOther.upper[i] : upper[i];
+			}
+			return *this;
+		}
+	};
+
+	template<class T, const uint32_t S>
+	class sphere {
+	public:
+		typedef T type;
+		typedef vector<T,S> point_t;
+		enum{DIMENSIONS = S};
+	public:
+		point_t centre;
+		T radius;
+	public:
+		sphere() :
+			centre(static_cast<T>(0)),
+			radius(static_cast<T>(0))
+		{}
+
+		sphere(const point_t& aCentre, const T aRadius) :
+			centre(aCentre),
+			radius(aRadius)
+		{}
+
+		inline bool contains(const point_t& aPoint) const throw() {
+			return (aPoint - centre).magnitude_sq() <= radius * radius;
+		}
+
+		inline bool intersects(const sphere<T,S>& aOther) const throw() {
+			const T r = radius + aOther.radius;
+			return (aOther.centre - centre).magnitude_sq() <= r * r;
+		}
+
+		bool intersects(const aabb<T,S>& aBox) const throw() {
+			T distance = static_cast<T>(0);
+			for(uint32_t i = 0; i < S; ++i) {
+				const T c = centre[i];
+				const T d = c < aBox.lower[i] ? aBox.lower[i] - c : c > aBox.upper[i] ? c - aBox.upper[i] : static_cast<T>(0);
+				distance += d * d;
+			}
+			return distance <= radius * radius;
+		}
+
+		inline aabb<T,S> bounds() const throw() {
+			return aabb<T,S>(centre - radius, centre + radius);
+		}
+	};
+
+	template<class T, const uint32_t S>
+	class plane {
+	public:
+		typedef T type;
+		typedef vector<T,S> point_t;
+		enum{DIMENSIONS = S};
+	public:
+		point_t normal;		//!< Unit normal, points towards the positive half-space
+		T distance;			//!< signed_distance(p) = normal . p + distance
+	public:
+		plane() :
+			normal(static_cast<T>(0)),
+			distance(static_cast<T>(0))
+		{}
+
+		plane(const point_t& aNormal, const T aDistance) :
+			normal(aNormal),
+			distance(aDistance)
+		{}
+
+		plane(const point_t& aNormal, const point_t& aPoint) :
+			normal(aNormal),
+			distance(-aNormal.dot_product(aPoint))
+		{}
+
+		inline T signed_distance(const point_t& aPoint) const throw() {
+			return normal.dot_product(aPoint) + distance;
+		}
+
+		//! \brief Rescale so that the normal has unit length
+		plane<T,S>& normalise() throw() {
+			const T inverse = static_cast<T>(1) / normal.magnitude();
+			normal *= inverse;
+			distance *= inverse;
+			return *this;
+		}
+	};
+
+	template<class T, const uint32_t S>
+	class ray {
+	public:
+		typedef T type;
+		typedef vector<T,S> point_t;
+		enum{DIMENSIONS = S};
+	public:
+		point_t origin;
+		point_t direction;
+	public:
+		ray() :
+			origin(static_cast<T>(0)),
+			direction(static_cast<T>(0))
+		{}
+
+		ray(const point_t& aOrigin, const point_t& aDirection) :
+			origin(aOrigin),
+			direction(aDirection)
+		{}
+
+		inline point_t point_at(const T aDistance) const throw() {
+			return origin + direction * aDistance;
+		}
+
+		inline point_t inverse_direction() const throw() {
+			return static_cast<T>(1) / direction;
+		}
+
+		//! \brief Slab test, on a hit aNear and aFar are clipped to the entry and exit distances
+		bool intersects(const aabb<T,S>& aBox, T& aNear, T& aFar) const throw() {
+			for(uint32_t i = 0; i < S; ++i) {
+				const T inverse = static_cast<T>(1) / direction[i];
+				T t0 = (aBox.lower[i] - origin[i]) * inverse;
+				T t1 = (aBox.upper[i] - origin[i]) * inverse;
+				if(t0 > t1) {
+					const T tmp = t0;
+					t0 = t1;
+					t1 = tmp;
+				}
+				if(t0 > aNear) aNear = t0;
+				if(t1 < aFar) aFar = t1;
+				if(aNear > aFar) return false;
+			}
+			return true;
+		}
+
+		//! \brief On a hit aDistance is set to the nearest non-negative intersection distance
+		bool intersects(const sphere<T,S>& aSphere, T& aDistance) const throw() {
+			const point_t offset = origin - aSphere.centre;
+			const T a = direction.magnitude_sq();
+			const T b = offset.dot_product(direction);
+			const T c = offset.magnitude_sq() - aSphere.radius * aSphere.radius;
+			const T discriminant = b * b - a * c;
+			if(discriminant < static_cast<T>(0)) return false;
+			const T root = static_cast<T>(std::sqrt(discriminant));
+			T t = (-b - root) / a;
+			if(t < static_cast<T>(0)) t = (-b + root) / a;
+			if(t < static_cast<T>(0)) return false;
+			aDistance = t;
+			return true;
+		}
+
+		bool intersects(const plane<T,S>& aPlane, T& aDistance) const throw() {
+			const T denominator = aPlane.normal.dot_product(direction);
+			if(denominator == static_cast<T>(0)) return false;
+			const T t = -aPlane.signed_distance(origin) / denominator;
+			if(t < static_cast<T>(0)) return false;
+			aDistance = t;
+			return true;
+		}
+	};
+
+	template<class T>
+	class frustum {
+	public:
+		typedef T type;
+		typedef vector<T,3> point_t;
+		enum {
+			LEFT,
+			RIGHT,
+			BOTTOM,
+			TOP,
+			NEAR_PLANE,
+			FAR_PLANE,
+			PLANE_COUNT
+		};
+	public:
+		plane<T,3> planes[PLANE_COUNT];	//!< Normals point inwards
+	public:
+		frustum() {}
+
+		//! \brief Extract the planes of a view-projection matrix (column vectors, clip space z in [-w, w])
+		explicit frustum(const matrix<T,4,4>& aMatrix) {
+			const T* const r0 = aMatrix[0];
+			const T* const r1 = aMatrix[1];
+			const T* const r2 = aMatrix[2];
+			const T* const r3 = aMatrix[3];
+			for(uint32_t i = 0; i < PLANE_COUNT; ++i) {
+				const T* const row = i < 2 ? r0 : i < 4 ? r1 : r2;
+				const T sign = (i & 1) ? static_cast<T>(-1) : static_cast<T>(1);
+				planes[i] = plane<T,3>(
+					point_t(r3[0] + sign * row[0], r3[1] + sign * row[1], r3[2] + sign * row[2]),
+					r3[3] + sign * row[3]
+				);
+				planes[i].normalise();
+			}
+		}
+
+		bool contains(const point_t& aPoint) const throw() {
+			for(uint32_t i = 0; i < PLANE_COUNT; ++i) if(planes[i].signed_distance(aPoint) < static_cast<T>(0)) return false;
+			return true;
+		}
+
+		bool intersects(const sphere<T,3>& aSphere) const throw() {
+			for(uint32_t i = 0; i < PLANE_COUNT; ++i) if(planes[i].signed_distance(aSphere.centre) < -aSphere.radius) return false;
+			return true;
+		}
+
+		//! \brief Conservative test, may report boxes just outside a frustum corner as intersecting
+		bool intersects(const aabb<T,3>& aBox) const throw() {
+			for(uint32_t i = 0; i < PLANE_COUNT; ++i) {
+				const plane<T,3>& p = planes[i];
+				const point_t positive(
+					p.normal[0] >= static_cast<T>(0) ? aBox.upper[0] : aBox.lower[0],
+					p.normal[1] >= static_cast<T>(0) ? aBox.upper[1] : aBox.lower[1],
+					p.normal[2] >= static_cast<T>(0) ? aBox.upper[2] : aBox.lower[2]
+				);
+				if(p.signed_distance(positive) < static_cast<T>(0)) return false;
+			}
+			return true;
+		}
+	};
+
+	// SoA packets, the batched tests run across the N lanes of a packet at once
+
+	template<class T, const uint32_t S, const uint32_t N>
+	class aabb_packet {
+	public:
+		enum{WIDTH = N};
+	public:
+		T lower[S][N];
+		T upper[S][N];
+	public:
+		void set(const uint32_t aIndex, const aabb<T,S>& aBox) throw() {
+			for(uint32_t i = 0; i < S; ++i) {
+				lower[i][aIndex] = aBox.lower[i];
+				upper[i][aIndex] = aBox.upper[i];
+			}
+		}
+
+		aabb<T,S> get(const uint32_t aIndex) const throw() {
+			aabb<T,S> tmp;
+			for(uint32_t i = 0; i < S; ++i) {
+				tmp.lower[i] = lower[i][aIndex];
+				tmp.upper[i] = upper[i][aIndex];
+			}
+			return tmp;
+		}
+	};
+
+	template<class T, const uint32_t S, const uint32_t N>
+	class sphere_packet {
+	public:
+		enum{WIDTH = N};
+	public:
+		T centre[S][N];
+		T radius[N];
+	public:
+		void set(const uint32_t aIndex, const sphere<T,S>& aSphere) throw() {
+			for(uint32_t i = 0; i < S; ++i) centre[i][aIndex] = aSphere.centre[i];
+			radius[aIndex] = aSphere.radius;
+		}
+
+		sphere<T,S> get(const uint32_t aIndex) const throw() {
+			sphere<T,S> tmp;
+			for(uint32_t i = 0; i < S; ++i) tmp.centre[i] = centre[i][aIndex];
+			tmp.radius = radius[aIndex];
+			return tmp;
+		}
+	};
+
+	//! \brief Test one ray against N boxes, aDistances (optional) receives the entry distance of each lane
+	template<class T, const uint32_t S, const uint32_t N>
+	vector_mask<N> intersects(const ray<T,S>& aRay, const aabb_packet<T,S,N>& aBoxes, const T aMaxDistance, T* const aDistances = nullptr) throw() {
+		T tNear[N];
+		T tFar[N];
+		for(uint32_t j = 0; j < N; ++j) {
+			tNear[j] = static_cast<T>(0);
+			tFar[j] = aMaxDistance;
+		}
+
+		for(uint32_t i = 0; i < S; ++i) {
+			const T inverse = static_cast<T>(1) / aRay.direction[i];
+			const T origin = aRay.origin[i];
+			const T* const lower = aBoxes.lower[i];
+			const T* const upper = aBoxes.upper[i];
+			for(uint32_t j = 0; j < N; ++j) {
+				const T t0 = (lower[j] - origin) * inverse;
+				const T t1 = (upper[j] - origin) * inverse;
+				const T tMin = t0 < t1 ? t0 : t1;
+				const T tMax = t0 < t1 ? t1 : t0;
+				tNear[j] = tMin > tNear[j] ? tMin : tNear[j];
+				tFar[j] = tMax < tFar[j] ? tMax : tFar[j];
+			}
+		}
+
+		typename vector_mask<N>::type hits = 0;
+		for(uint32_t j = 0; j < N; ++j) hits |= static_cast<typename vector_mask<N>::type>(tNear[j] <= tFar[j]) << j;
+		if(aDistances) for(uint32_t j = 0; j < N; ++j) aDistances[j] = tNear[j];
+		return vector_mask<N>(hits);
+	}
+
+	template<class T, const uint32_t N>
+	vector_mask<N> intersects(const frustum<T>& aFrustum, const sphere_packet<T,3,N>& aSpheres) throw() {
+		bool inside[N];
+		for(uint32_t j = 0; j < N; ++j) inside[j] = true;
+
+		for(uint32_t i = 0; i < frustum<T>::PLANE_COUNT; ++i) {
+			const plane<T,3>& p = aFrustum.planes[i];
+			const T nx = p.normal[0];
+			const T ny = p.normal[1];
+			const T nz = p.normal[2];
+			const T d = p.distance;
+			for(uint32_t j = 0; j < N; ++j) {
+				const T distance = nx * aSpheres.centre[0][j] + ny * aSpheres.centre[1][j] + nz * aSpheres.centre[2][j] + d;
+				inside[j] = inside[j] & (distance >= -aSpheres.radius[j]);
+			}
+		}
+
+		typename vector_mask<N>::type result = 0;
+		for(uint32_t j = 0; j < N; ++j) result |= static_cast<typename vector_mask<N>::type>(inside[j]) << j;
+		return vector_mask<N>(result);
+	}
+
+	template<class T, const uint32_t N>
+	vector_mask<N> intersects(const frustum<T>& aFrustum, const aabb_packet<T,3,N>& aBoxes) throw() {
+		bool inside[N];
+		for(uint32_t j = 0; j < N; ++j) inside[j] = true;
+
+		for(uint32_t i = 0; i < frustum<T>::PLANE_COUNT; ++i) {
+			const plane<T,3>& p = aFrustum.planes[i];
+			const T* const x = p.normal[0] >= static_cast<T>(0) ? aBoxes.upper[0] : aBoxes.lower[0];
+			const T* const y = p.normal[1] >= static_cast<T>(0) ? aBoxes.upper[1] : aBoxes.lower[1];
+			const T* const z = p.normal[2] >= static_cast<T>(0) ? aBoxes.upper[2] : aBoxes.lower[2];
+			for(uint32_t j = 0; j < N; ++j) {
+				const T distance = p.normal[0] * x[j] + p.normal[1] * y[j] + p.normal[2] * z[j] + p.distance;
+				inside[j] = inside[j] & (distance >= static_cast<T>(0));
+			}
+		}
+
+		typename vector_mask<N>::type result = 0;
+		for(uint32_t j = 0; j < N; ++j) result |= static_cast<typename vector_mask<N>::type>(inside[j]) << j;
+		return vector_mask<N>(result);
+	}
+
+	#if defined(SOLAIRE_MATHS_SSE2)
+		// SSE versions for float packets with a width that is a multiple of 4
+
+		template<const uint32_t S, const uint32_t N>
+		typename std::enable_if<N % 4 == 0, vector_mask<N>>::type
+		intersects(const ray<float,S>& aRay, const aabb_packet<float,S,N>& aBoxes, const float aMaxDistance, float* const aDistances = nullptr) throw() {
+			__m128 inverse[S];
+			__m128 origin[S];
+			for(uint32_t i = 0; i < S; ++i) {
+				inverse[i] = _mm_set1_ps(1.f / aRay.direction[i]);
+				origin[i] = _mm_set1_ps(aRay.origin[i]);
+			}
+
+			typename vector_mask<N>::type hits = 0;
+			for(uint32_t j = 0; j < N; j += 4) {
+				__m128 tNear = _mm_setzero_ps();
+				__m128 tFar = _mm_set1_ps(aMaxDistance);
+				for(uint32_t i = 0; i < S; ++i) {
+					const __m128 t0 = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(aBoxes.lower[i] + j), origin[i]), inverse[i]);
+					const __m128 t1 = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(aBoxes.upper[i] + j), origin[i]), inverse[i]);
+					tNear = _mm_max_ps(tNear, _mm_min_ps(t0, t1));
+					tFar = _mm_min_ps(tFar, _mm_max_ps(t0, t1));
+				}
+				hits |= static_cast<typename vector_mask<N>::type>(_mm_movemask_ps(_mm_cmple_ps(tNear, tFar))) << j;
+				if(aDistances) _mm_storeu_ps(aDistances + j, tNear);
+			}
+			return vector_mask<N>(hits);
+		}
+
+		template<const uint32_t N>
+		typename std::enable_if<N % 4 == 0, vector_mask<N>>::type
+		intersects(const frustum<float>& aFrustum, const sphere_packet<float,3,N>& aSpheres) throw() {
+			typename vector_mask<N>::type result = 0;
+			for(uint32_t j = 0; j < N; j += 4) {
+				const __m128 x = _mm_loadu_ps(aSpheres.centre[0] + j);
+				const __m128 y = _mm_loadu_ps(aSpheres.centre[1] + j);
+				const __m128 z = _mm_loadu_ps(aSpheres.centre[2] + j);
+				const __m128 radius = _mm_sub_ps(_mm_setzero_ps(), _mm_loadu_ps(aSpheres.radius + j));
+				__m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+				for(uint32_t i = 0; i < frustum<float>::PLANE_COUNT; ++i) {
+					const plane<float,3>& p = aFrustum.planes[i];
+					__m128 distance = _mm_mul_ps(x, _mm_set1_ps(p.normal[0]));
+					distance = _mm_add_ps(distance, _mm_mul_ps(y, _mm_set1_ps(p.normal[1])));
+					distance = _mm_add_ps(distance, _mm_mul_ps(z, _mm_set1_ps(p.normal[2])));
+					distance = _mm_add_ps(distance, _mm_set1_ps(p.distance));
+					inside = _mm_and_ps(inside, _mm_cmpge_ps(distance, radius));
+				}
+				result |= static_cast<typename vector_mask<N>::type>(_mm_movemask_ps(inside)) << j;
+			}
+			return vector_mask<N>(result);
+		}
+
+		template<const uint32_t N>
+		typename std::enable_if<N % 4 == 0, vector_mask<N>>::type
+		intersects(const frustum<float>& aFrustum, const aabb_packet<float,3,N>& aBoxes) throw() {
+			typename vector_mask<N>::type result = 0;
+			for(uint32_t j = 0; j < N; j += 4) {
+				__m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+				for(uint32_t i = 0; i < frustum<float>::PLANE_COUNT; ++i) {
+					const plane<float,3>& p = aFrustum.planes[i];
+					__m128 distance = _mm_set1_ps(p.distance);
+					for(uint32_t k = 0; k < 3; ++k) {
+						const float* const corner = p.normal[k] >= 0.f ? aBoxes.upper[k] : aBoxes.lower[k];
+						distance = _mm_add_ps(distance, _mm_mul_ps(_mm_loadu_ps(corner + j), _mm_set1_ps(p.normal[k])));
+					}
+					inside = _mm_and_ps(inside, _mm_cmpge_ps(distance, _mm_setzero_ps()));
+				}
+				result |= static_cast<typename vector_mask<N>::type>(_mm_movemask_ps(inside)) << j;
+			}
+			return vector_mask<N>(result);
+		}
+	#endif
+
+	//! \brief Cull an array of packets, aResults[i] receives the visibility mask of aPackets[i]
+	template<class T, const uint32_t N>
+	void intersects(const frustum<T>& aFrustum, const sphere_packet<T,3,N>* const aPackets, vector_mask<N>* const aResults, const uint32_t aCount) throw() {
+		for(uint32_t i = 0; i < aCount; ++i) aResults[i] = intersects(aFrustum, aPackets[i]);
+	}
+
+	template<class T, const uint32_t N>
+	void intersects(const frustum<T>& aFrustum, const aabb_packet<T,3,N>* const aPackets, vector_mask<N>* const aResults, const uint32_t aCount) throw() {
+		for(uint32_t i = 0; i < aCount; ++i) aResults[i] = intersects(aFrustum, aPackets[i]);
+	}
+
+	#define SOLAIRE_DEF_GEOMETRY(aNum)\
+		typedef aabb<float, aNum> aabb_ ## aNum ## f;\
+		typedef aabb<double, aNum> aabb_ ## aNum ## d;\
+		typedef sphere<float, aNum> sphere_ ## aNum ## f;\
+		typedef sphere<double, aNum> sphere_ ## aNum ## d;\
+		typedef plane<float, aNum> plane_ ## aNum ## f;\
+		typedef plane<double, aNum> plane_ ## aNum ## d;\
+		typedef ray<float, aNum> ray_ ## aNum ## f;\
+		typedef ray<double, aNum> ray_ ## aNum ## d;
+
+	SOLAIRE_DEF_GEOMETRY(2)
+	SOLAIRE_DEF_GEOMETRY(3)
+	typedef frustum<float> frustum_f;
+	typedef frustum<double> frustum_d;
+
+	#undef SOLAIRE_DEF_GEOMETRY
+}
+
+#endif
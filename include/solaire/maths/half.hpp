@@ -0,0 +1,193 @@
+#ifndef SOLAIRE_HALF_HPP
+#define SOLAIRE_HALF_HPP
+
+//Copyright 2016 Adam G. Smith
+//
+//Licensed under the Apache License, Version 2.0 (the "License");
+//you may not use this file except in compliance with the License.
+//You may obtain a copy of the License at
+//
+//http ://www.apache.org/licenses/LICENSE-2.0
+//
+//Unless required by applicable law or agreed to in writing, software
+//distributed under the License is distributed on an "AS IS" BASIS,
+//WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//See the License for the specific language governing permissions and
+//limitations under the License.
+
+#include <cstring>
+#include "solaire/maths/maths.hpp"
+#include "solaire/maths/instrument.hpp"
+
+extern "C" SOLAIRE_EXPORT_API void SOLAIRE_EXPORT_CALL solaire_half_to_float(const uint16_t*, float*, const uint32_t);
+extern "C" SOLAIRE_EXPORT_API void SOLAIRE_EXPORT_CALL solaire_float_to_half(const float*, uint16_t*, const uint32_t);
+
+namespace solaire {
+
+	inline float half_bits_to_float(const uint16_t aBits) throw() {
+		const uint32_t sign = static_cast<uint32_t>(aBits & 0x8000) << 16;
+		uint32_t exponent = (aBits >> 10) & 0x1F;
+		uint32_t mantissa = aBits & 0x3FF;
+		uint32_t bits;
+
+		if(exponent == 0x1F) {
+			bits = sign | 0x7F800000 | (mantissa << 13);
+		}else if(exponent == 0) {
+			if(mantissa == 0) {
+				bits = sign;
+			}else {
+				exponent = 113;
+				while(! (mantissa & 0x400)) {
+					mantissa <<= 1;
+					--exponent;
+				}
+				bits = sign | (exponent << 23) | ((mantissa & 0x3FF) << 13);
+			}
+		}else {
+			bits = sign | ((exponent + 112) << 23) | (mantissa << 13);
+		}
+
+		float tmp;
+		std::memcpy(&tmp, &bits, sizeof(float));
+		return tmp;
+	}
+
+	inline uint16_t float_to_half_bits(const float aValue) throw() {
+		uint32_t bits;
+		std::memcpy(&bits, &aValue, sizeof(float));
+		const uint16_t sign = static_cast<uint16_t>((bits >> 16) & 0x8000);
+		bits &= 0x7FFFFFFF;
+
+		// Overflow, infinity and NaN
+		if(bits >= 0x47800000) return sign | (bits > 0x7F800000 ? 0x7E00 : 0x7C00);
+
+		// Subnormal or zero
+		if(bits < 0x38800000) {
+			if(bits <= 0x33000000) return sign;
+			const uint32_t shift = 126 - (bits >> 23);
+			const uint32_t mantissa = (bits & 0x7FFFFF) | 0x800000;
+			const uint32_t remainder = mantissa & ((1u << shift) - 1);
+			const uint32_t halfway = 1u << (shift - 1);
+			uint32_t tmp = mantissa >> shift;
+			if(remainder > halfway || (remainder == halfway && (tmp & 1))) ++tmp;
+			return sign | static_cast<uint16_t>(tmp);
+		}
+
+		// Normal, round to nearest even
+		uint32_t tmp = (bits - 0x38000000) >> 13;
+		const uint32_t remainder = bits & 0x1FFF;
+		if(remainder > 0x1000 || (remainder == 0x1000 && (tmp & 1))) ++tmp;
+		return sign | static_cast<uint16_t>(tmp);
+	}
+
+	class half {
+	public:
+		typedef uint16_t type;
+	private:
+		type mBits;
+	public:
+		SOLAIRE_CONSTEXPR_11 half() throw() :
+			mBits(0)
+		{}
+
+		template<class T2, typename ENABLE = typename std::enable_if<std::is_arithmetic<T2>::value>::type>
+		half(const T2 aValue) throw() :
+			mBits(float_to_half_bits(static_cast<float>(aValue)))
+		{}
+
+		static SOLAIRE_CONSTEXPR_I11 half from_bits(const type aBits) throw() {
+			return half(aBits, 0);
+		}
+
+		SOLAIRE_CONSTEXPR_I11 type get_bits() const throw() {
+			return mBits;
+		}
+
+		template<class T2, typename ENABLE = typename std::enable_if<std::is_arithmetic<T2>::value>::type>
+		inline explicit operator T2() const throw() {
+			return static_cast<T2>(half_bits_to_float(mBits));
+		}
+
+		inline half& operator+=(const half aOther) throw() {
+			return *this = half(static_cast<float>(*this) + static_cast<float>(aOther));
+		}
+
+		inline half& operator-=(const half aOther) throw() {
+			return *this = half(static_cast<float>(*this) - static_cast<float>(aOther));
+		}
+
+		inline half& operator*=(const half aOther) throw() {
+			return *this = half(static_cast<float>(*this) * static_cast<float>(aOther));
+		}
+
+		inline half& operator/=(const half aOther) throw() {
+			return *this = half(static_cast<float>(*this) / static_cast<float>(aOther));
+		}
+
+		inline half operator+(const half aOther) const throw() {
+			return half(*this) += aOther;
+		}
+
+		inline half operator-(const half aOther) const throw() {
+			return half(*this) -= aOther;
+		}
+
+		inline half operator*(const half aOther) const throw() {
+			return half(*this) *= aOther;
+		}
+
+		inline half operator/(const half aOther) const throw() {
+			return half(*this) /= aOther;
+		}
+
+		SOLAIRE_CONSTEXPR_I11 half operator-() const throw() {
+			return half(static_cast<type>(mBits ^ 0x8000), 0);
+		}
+
+		inline bool operator==(const half aOther) const throw() {
+			return static_cast<float>(*this) == static_cast<float>(aOther);
+		}
+
+		inline bool operator!=(const half aOther) const throw() {
+			return static_cast<float>(*this) != static_cast<float>(aOther);
+		}
+
+		inline bool operator<(const half aOther) const throw() {
+			return static_cast<float>(*this) < static_cast<float>(aOther);
+		}
+
+		inline bool operator>(const half aOther) const throw() {
+			return static_cast<float>(*this) > static_cast<float>(aOther);
+		}
+
+		inline bool operator<=(const half aOther) const throw() {
+			return static_cast<float>(*this) <= static_cast<float>(aOther);
+		}
+
+		inline bool operator>=(const half aOther) const throw() {
+			return static_cast<float>(*this) >= static_cast<float>(aOther);
+		}
+	private:
+		SOLAIRE_CONSTEXPR_11 half(const type aBits, int) throw() :
+			mBits(aBits)
+		{}
+	};
+
+	static_assert(sizeof(half) == sizeof(uint16_t), "solaire::half : Must be the same size as uint16_t");
+
+	inline void convert(const half* const aInput, float* const aOutput, const uint32_t aCount) throw() {
+		SOLAIRE_INSTRUMENT(INSTRUMENT_VECTOR_BATCH, aCount);
+		solaire_half_to_float(reinterpret_cast<const uint16_t*>(aInput), aOutput, aCount);
+	}
+
+	inline void convert(const float* const aInput, half* const aOutput, const uint32_t aCount) throw() {
+		SOLAIRE_INSTRUMENT(INSTRUMENT_VECTOR_BATCH, aCount);
+		solaire_float_to_half(aInput, reinterpret_cast<uint16_t*>(aOutput), aCount);
+	}
+
+	inline std::ostream& operator<<(std::ostream& aStream, const half aValue) {
+		return aStream << static_cast<float>(aValue);
+	}
+}
+
+#endif
\ No newline at end of file
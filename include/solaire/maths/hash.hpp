@@ -0,0 +1,87 @@
+#ifndef SOLAIRE_HASH_HPP
+#define SOLAIRE_HASH_HPP
+
+//Copyright 2016 Adam G. Smith
+//
+//Licensed under the Apache License, Version 2.0 (the "License");
+//you may not use this file except in compliance with the License.
+//You may obtain a copy of the License at
+//
+//http ://www.apache.org/licenses/LICENSE-2.0
+//
+//Unless required by applicable law or agreed to in writing, software
+//distributed under the License is distributed on an "AS IS" BASIS,
+//WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//See the License for the specific language governing permissions and
+//limitations under the License.
+
+#include <functional>
+#include "solaire/maths/vector.hpp"
+#include "solaire/maths/instrument.hpp"
+
+extern "C" SOLAIRE_EXPORT_API void SOLAIRE_EXPORT_CALL solaire_hash_cells(const int32_t*, uint32_t*, const uint32_t, const uint32_t);
+
+namespace solaire {
+
+	enum : uint32_t {
+		HASH_SEED = 0x811C9DC5,
+		HASH_MULTIPLIER = 0x9E3779B1
+	};
+
+	//! \brief Murmur3 finaliser, every input bit affects every output bit
+	SOLAIRE_CONSTEXPR_I14 uint32_t hash_mix(uint32_t aValue) throw() {
+		aValue ^= aValue >> 16;
+		aValue *= 0x85EBCA6B;
+		aValue ^= aValue >> 13;
+		aValue *= 0xC2B2AE35;
+		aValue ^= aValue >> 16;
+		return aValue;
+	}
+
+	SOLAIRE_CONSTEXPR_I14 uint64_t hash_mix(uint64_t aValue) throw() {
+		aValue ^= aValue >> 33;
+		aValue *= 0xFF51AFD7ED558CCDull;
+		aValue ^= aValue >> 33;
+		aValue *= 0xC4CEB9FE1A85EC53ull;
+		aValue ^= aValue >> 33;
+		return aValue;
+	}
+
+	//! \brief 32 bit hash of an integer vector, the same value is produced by hash_cells
+	template<class T, const uint32_t S, typename ENABLE = typename std::enable_if<std::is_integral<T>::value && sizeof(T) <= sizeof(uint32_t)>::type>
+	SOLAIRE_CONSTEXPR_I14 uint32_t hash_cell(const vector<T,S>& aCell) throw() {
+		uint32_t h = HASH_SEED;
+		for(uint32_t i = 0; i < S; ++i) h = (h ^ static_cast<uint32_t>(aCell[i])) * HASH_MULTIPLIER;
+		return hash_mix(h);
+	}
+
+	template<class T, const uint32_t S, typename ENABLE = typename std::enable_if<std::is_integral<T>::value>::type>
+	SOLAIRE_CONSTEXPR_I14 uint64_t hash_cell_64(const vector<T,S>& aCell) throw() {
+		uint64_t h = 0xCBF29CE484222325ull;
+		for(uint32_t i = 0; i < S; ++i) h = (h ^ static_cast<uint64_t>(aCell[i])) * 0x9E3779B97F4A7C15ull;
+		return hash_mix(h);
+	}
+
+	//! \brief Hash aCount cells at once, hashes are identical to hash_cell
+	template<const uint32_t S>
+	inline void hash_cells(const vector<int32_t,S>* const aCells, uint32_t* const aHashes, const uint32_t aCount) throw() {
+		SOLAIRE_INSTRUMENT(INSTRUMENT_HASH, aCount);
+		solaire_hash_cells(reinterpret_cast<const int32_t*>(aCells), aHashes, aCount, S);
+	}
+}
+
+namespace std {
+	template<class T, const uint32_t S>
+	struct hash<solaire::vector<T,S>> {
+		static_assert(std::is_integral<T>::value, "std::hash<solaire::vector> : Only integer vectors can be hashed");
+
+		typedef solaire::vector<T,S> argument_type;
+		typedef size_t result_type;
+
+		inline size_t operator()(const solaire::vector<T,S>& aCell) const throw() {
+			return static_cast<size_t>(solaire::hash_cell_64(aCell));
+		}
+	};
+}
+
+#endif
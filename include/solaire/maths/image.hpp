@@ -0,0 +1,163 @@
+#ifndef SOLAIRE_IMAGE_HPP
+#define SOLAIRE_IMAGE_HPP
+
+//Copyright 2016 Adam G. Smith
+//
+//Licensed under the Apache License, Version 2.0 (the "License");
+//you may not use this file except in compliance with the License.
+//You may obtain a copy of the License at
+//
+//http ://www.apache.org/licenses/LICENSE-2.0
+//
+//Unless required by applicable law or agreed to in writing, software
+//distributed under the License is distributed on an "AS IS" BASIS,
+//WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//See the License for the specific language governing permissions and
+//limitations under the License.
+
+#include "solaire/maths/vector.hpp"
+#include "solaire/maths/parallel.hpp"
+#include "solaire/maths/instrument.hpp"
+
+extern "C" SOLAIRE_EXPORT_API void SOLAIRE_EXPORT_CALL solaire_u8_add_saturate(const uint8_t*, const uint8_t*, uint8_t*, const uint32_t);
+extern "C" SOLAIRE_EXPORT_API void SOLAIRE_EXPORT_CALL solaire_u8_sub_saturate(const uint8_t*, const uint8_t*, uint8_t*, const uint32_t);
+extern "C" SOLAIRE_EXPORT_API void SOLAIRE_EXPORT_CALL solaire_u8_to_float(const uint8_t*, float*, const uint32_t, const float);
+extern "C" SOLAIRE_EXPORT_API void SOLAIRE_EXPORT_CALL solaire_float_to_u8(const float*, uint8_t*, const uint32_t, const float);
+extern "C" SOLAIRE_EXPORT_API void SOLAIRE_EXPORT_CALL solaire_rgba_blend(const uint8_t*, const uint8_t*, uint8_t*, const uint32_t);
+extern "C" SOLAIRE_EXPORT_API void SOLAIRE_EXPORT_CALL solaire_rgba_blend_premultiplied(const uint8_t*, const uint8_t*, uint8_t*, const uint32_t);
+extern "C" SOLAIRE_EXPORT_API void SOLAIRE_EXPORT_CALL solaire_rgba_premultiply(const uint8_t*, uint8_t*, const uint32_t);
+extern "C" SOLAIRE_EXPORT_API void SOLAIRE_EXPORT_CALL solaire_rgb_to_rgba(const uint8_t*, uint8_t*, const uint32_t, const uint8_t);
+extern "C" SOLAIRE_EXPORT_API void SOLAIRE_EXPORT_CALL solaire_rgba_to_rgb(const uint8_t*, uint8_t*, const uint32_t);
+extern "C" SOLAIRE_EXPORT_API void SOLAIRE_EXPORT_CALL solaire_srgb_to_linear(const uint8_t*, float*, const uint32_t);
+extern "C" SOLAIRE_EXPORT_API void SOLAIRE_EXPORT_CALL solaire_linear_to_srgb(const float*, uint8_t*, const uint32_t);
+
+namespace solaire {
+
+	enum : uint32_t {
+		IMAGE_PARALLEL_GRAIN = 1 << 16,	//!< Minimum pixels handed to a thread by the image kernels
+		IMAGE_SRGB_TABLE = 4096			//!< Entries in the linear to sRGB table, results are within 1 of exact rounding
+	};
+
+	//! \brief Exact sRGB transfer functions, the bulk kernels use tables built from these
+	inline float srgb_to_linear(const float aValue) throw() {
+		return aValue <= 0.04045f ? aValue / 12.92f : std::pow((aValue + 0.055f) / 1.055f, 2.4f);
+	}
+
+	inline float linear_to_srgb(const float aValue) throw() {
+		return aValue <= 0.0031308f ? aValue * 12.92f : 1.055f * std::pow(aValue, 1.f / 2.4f) - 0.055f;
+	}
+
+	// Saturating arithmetic, works per channel so alpha is included for vector_rgba
+
+	template<const uint32_t S>
+	void add_saturate(const vector<uint8_t,S>* const aFirst, const vector<uint8_t,S>* const aSecond, vector<uint8_t,S>* const aOutput, const uint32_t aCount) {
+		SOLAIRE_INSTRUMENT(INSTRUMENT_IMAGE, aCount);
+		const uint8_t* const first = reinterpret_cast<const uint8_t*>(aFirst);
+		const uint8_t* const second = reinterpret_cast<const uint8_t*>(aSecond);
+		uint8_t* const output = reinterpret_cast<uint8_t*>(aOutput);
+		parallel_for(aCount, IMAGE_PARALLEL_GRAIN, [=](const uint32_t aBegin, const uint32_t aEnd) {
+			solaire_u8_add_saturate(first + aBegin * S, second + aBegin * S, output + aBegin * S, (aEnd - aBegin) * S);
+		});
+	}
+
+	template<const uint32_t S>
+	void sub_saturate(const vector<uint8_t,S>* const aFirst, const vector<uint8_t,S>* const aSecond, vector<uint8_t,S>* const aOutput, const uint32_t aCount) {
+		SOLAIRE_INSTRUMENT(INSTRUMENT_IMAGE, aCount);
+		const uint8_t* const first = reinterpret_cast<const uint8_t*>(aFirst);
+		const uint8_t* const second = reinterpret_cast<const uint8_t*>(aSecond);
+		uint8_t* const output = reinterpret_cast<uint8_t*>(aOutput);
+		parallel_for(aCount, IMAGE_PARALLEL_GRAIN, [=](const uint32_t aBegin, const uint32_t aEnd) {
+			solaire_u8_sub_saturate(first + aBegin * S, second + aBegin * S, output + aBegin * S, (aEnd - aBegin) * S);
+		});
+	}
+
+	// Compositing, colours are straight alpha unless stated otherwise
+
+	//! \brief Source over destination with straight alpha
+	//! \detail rgb = (src.rgb * src.a + dst.rgb * (255 - src.a)) / 255, a = src.a + dst.a * (255 - src.a) / 255
+	inline void alpha_blend(const vector_rgba* const aSource, const vector_rgba* const aDestination, vector_rgba* const aOutput, const uint32_t aCount) {
+		SOLAIRE_INSTRUMENT(INSTRUMENT_IMAGE, aCount);
+		parallel_for(aCount, IMAGE_PARALLEL_GRAIN, [=](const uint32_t aBegin, const uint32_t aEnd) {
+			solaire_rgba_blend(reinterpret_cast<const uint8_t*>(aSource + aBegin), reinterpret_cast<const uint8_t*>(aDestination + aBegin), reinterpret_cast<uint8_t*>(aOutput + aBegin), aEnd - aBegin);
+		});
+	}
+
+	//! \brief Source over destination with premultiplied alpha, out = src + dst * (255 - src.a) / 255
+	inline void alpha_blend_premultiplied(const vector_rgba* const aSource, const vector_rgba* const aDestination, vector_rgba* const aOutput, const uint32_t aCount) {
+		SOLAIRE_INSTRUMENT(INSTRUMENT_IMAGE, aCount);
+		parallel_for(aCount, IMAGE_PARALLEL_GRAIN, [=](const uint32_t aBegin, const uint32_t aEnd) {
+			solaire_rgba_blend_premultiplied(reinterpret_cast<const uint8_t*>(aSource + aBegin), reinterpret_cast<const uint8_t*>(aDestination + aBegin), reinterpret_cast<uint8_t*>(aOutput + aBegin), aEnd - aBegin);
+		});
+	}
+
+	inline void premultiply(const vector_rgba* const aInput, vector_rgba* const aOutput, const uint32_t aCount) {
+		SOLAIRE_INSTRUMENT(INSTRUMENT_IMAGE, aCount);
+		parallel_for(aCount, IMAGE_PARALLEL_GRAIN, [=](const uint32_t aBegin, const uint32_t aEnd) {
+			solaire_rgba_premultiply(reinterpret_cast<const uint8_t*>(aInput + aBegin), reinterpret_cast<uint8_t*>(aOutput + aBegin), aEnd - aBegin);
+		});
+	}
+
+	// Layout conversion
+
+	//! \brief aInput and aOutput must not overlap
+	inline void convert(const vector_rgb* const aInput, vector_rgba* const aOutput, const uint32_t aCount, const uint8_t aAlpha = 255) {
+		SOLAIRE_INSTRUMENT(INSTRUMENT_IMAGE, aCount);
+		parallel_for(aCount, IMAGE_PARALLEL_GRAIN, [=](const uint32_t aBegin, const uint32_t aEnd) {
+			solaire_rgb_to_rgba(reinterpret_cast<const uint8_t*>(aInput + aBegin), reinterpret_cast<uint8_t*>(aOutput + aBegin), aEnd - aBegin, aAlpha);
+		});
+	}
+
+	//! \brief aInput and aOutput must not overlap
+	inline void convert(const vector_rgba* const aInput, vector_rgb* const aOutput, const uint32_t aCount) {
+		SOLAIRE_INSTRUMENT(INSTRUMENT_IMAGE, aCount);
+		parallel_for(aCount, IMAGE_PARALLEL_GRAIN, [=](const uint32_t aBegin, const uint32_t aEnd) {
+			solaire_rgba_to_rgb(reinterpret_cast<const uint8_t*>(aInput + aBegin), reinterpret_cast<uint8_t*>(aOutput + aBegin), aEnd - aBegin);
+		});
+	}
+
+	// Normalised conversion, 0-255 maps to 0-1 and results are rounded and saturated
+
+	template<const uint32_t S>
+	void unpack(const vector<uint8_t,S>* const aInput, vector<float,S>* const aOutput, const uint32_t aCount) {
+		SOLAIRE_INSTRUMENT(INSTRUMENT_IMAGE, aCount);
+		parallel_for(aCount, IMAGE_PARALLEL_GRAIN, [=](const uint32_t aBegin, const uint32_t aEnd) {
+			solaire_u8_to_float(reinterpret_cast<const uint8_t*>(aInput + aBegin), reinterpret_cast<float*>(aOutput + aBegin), (aEnd - aBegin) * S, 1.f / 255.f);
+		});
+	}
+
+	template<const uint32_t S>
+	void pack(const vector<float,S>* const aInput, vector<uint8_t,S>* const aOutput, const uint32_t aCount) {
+		SOLAIRE_INSTRUMENT(INSTRUMENT_IMAGE, aCount);
+		parallel_for(aCount, IMAGE_PARALLEL_GRAIN, [=](const uint32_t aBegin, const uint32_t aEnd) {
+			solaire_float_to_u8(reinterpret_cast<const float*>(aInput + aBegin), reinterpret_cast<uint8_t*>(aOutput + aBegin), (aEnd - aBegin) * S, 255.f);
+		});
+	}
+
+	//! \brief Decode sRGB pixels to linear floats, alpha is always linear and only scaled
+	template<const uint32_t S>
+	void srgb_to_linear(const vector<uint8_t,S>* const aInput, vector<float,S>* const aOutput, const uint32_t aCount) {
+		static_assert(S == 3 || S == 4, "solaire::srgb_to_linear : Expected RGB or RGBA pixels");
+		SOLAIRE_INSTRUMENT(INSTRUMENT_IMAGE, aCount);
+		parallel_for(aCount, IMAGE_PARALLEL_GRAIN, [=](const uint32_t aBegin, const uint32_t aEnd) {
+			solaire_srgb_to_linear(reinterpret_cast<const uint8_t*>(aInput + aBegin), reinterpret_cast<float*>(aOutput + aBegin), (aEnd - aBegin) * S);
+			if(S == 4) for(uint32_t i = aBegin; i < aEnd; ++i) aOutput[i][3] = static_cast<float>(aInput[i][3]) * (1.f / 255.f);
+		});
+	}
+
+	//! \brief Encode linear floats to sRGB pixels, alpha is always linear and only scaled
+	template<const uint32_t S>
+	void linear_to_srgb(const vector<float,S>* const aInput, vector<uint8_t,S>* const aOutput, const uint32_t aCount) {
+		static_assert(S == 3 || S == 4, "solaire::linear_to_srgb : Expected RGB or RGBA pixels");
+		SOLAIRE_INSTRUMENT(INSTRUMENT_IMAGE, aCount);
+		parallel_for(aCount, IMAGE_PARALLEL_GRAIN, [=](const uint32_t aBegin, const uint32_t aEnd) {
+			solaire_linear_to_srgb(reinterpret_cast<const float*>(aInput + aBegin), reinterpret_cast<uint8_t*>(aOutput + aBegin), (aEnd - aBegin) * S);
+			if(S == 4) for(uint32_t i = aBegin; i < aEnd; ++i) {
+				// NaN maps to 0 like the colour channels
+				const float a = aInput[i][3] * 255.f + 0.5f;
+				aOutput[i][3] = static_cast<uint8_t>(! (a > 0.f) ? 0.f : a >= 255.f ? 255.f : a);
+			}
+		});
+	}
+}
+
+#endif
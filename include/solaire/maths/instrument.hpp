@@ -0,0 +1,167 @@
+#ifndef SOLAIRE_INSTRUMENT_HPP
+#define SOLAIRE_INSTRUMENT_HPP
+
+//Copyright 2016 Adam G. Smith
+//
+//Licensed under the Apache License, Version 2.0 (the "License");
+//you may not use this file except in compliance with the License.
+//You may obtain a copy of the License at
+//
+//http ://www.apache.org/licenses/LICENSE-2.0
+//
+//Unless required by applicable law or agreed to in writing, software
+//distributed under the License is distributed on an "AS IS" BASIS,
+//WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//See the License for the specific language governing permissions and
+//limitations under the License.
+
+#include <chrono>
+#include <vector>
+#include "solaire/maths/maths.hpp"
+
+#if defined(__x86_64__) || defined(__i386__)
+	#include <x86intrin.h>
+	#define SOLAIRE_MATHS_RDTSC
+#elif defined(_M_X64) || defined(_M_IX86)
+	#include <intrin.h>
+	#define SOLAIRE_MATHS_RDTSC
+#endif
+
+// Hooks are enabled by the library wide SOLAIRE_MATHS_INSTRUMENT option in maths.hpp, it must not differ between translation units.
+// When it is not defined the hooks expand to nothing.
+
+namespace solaire {
+
+	enum instrument_counter : uint32_t {
+		INSTRUMENT_MATRIX_MULTIPLY,
+		INSTRUMENT_VECTOR_BATCH,		//!< length_all, normalise_all, rsqrt_all, rcp_all, sqrt_all and conversions
+		INSTRUMENT_REDUCE,				//!< parallel_sum, parallel_dot
+		INSTRUMENT_SPARSE_MULTIPLY,
+		INSTRUMENT_SOLVER,
+		INSTRUMENT_NOISE,
+		INSTRUMENT_HASH,
+		INSTRUMENT_RANDOM,				//!< Bulk random operations
+		INSTRUMENT_IMAGE,				//!< Pixel kernels, elements are pixels
+		INSTRUMENT_COUNTER_COUNT
+	};
+
+	struct instrument_totals {
+		uint64_t calls;
+		uint64_t elements;
+		uint64_t cycles;	//!< Time stamp counter ticks, or nanoseconds where there is no time stamp counter
+	};
+
+	struct instrument_snapshot {
+		uint32_t thread;	//!< INSTRUMENT_RETIRED for the combined totals of threads that have exited
+		instrument_totals counters[INSTRUMENT_COUNTER_COUNT];
+	};
+
+	enum : uint32_t {
+		INSTRUMENT_RETIRED = 0xFFFFFFFF,
+		INSTRUMENT_TRACE_CAPACITY = 1 << 16	//!< Trace events kept per thread and for all exited threads, later events are dropped
+	};
+}
+
+extern "C" SOLAIRE_EXPORT_API void SOLAIRE_EXPORT_CALL solaire_instrument_record(const solaire::instrument_counter, const uint64_t, const uint64_t, const uint64_t, const uint64_t);
+extern "C" SOLAIRE_EXPORT_API uint32_t SOLAIRE_EXPORT_CALL solaire_instrument_snapshot(solaire::instrument_snapshot*, const uint32_t);
+extern "C" SOLAIRE_EXPORT_API void SOLAIRE_EXPORT_CALL solaire_instrument_reset();
+extern "C" SOLAIRE_EXPORT_API void SOLAIRE_EXPORT_CALL solaire_instrument_set_trace(const bool);
+extern "C" SOLAIRE_EXPORT_API bool SOLAIRE_EXPORT_CALL solaire_instrument_write_trace(const char*);
+
+namespace solaire {
+
+	inline uint64_t instrument_cycles() throw() {
+		#if defined(SOLAIRE_MATHS_RDTSC)
+			return __rdtsc();
+		#else
+			return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+		#endif
+	}
+
+	inline uint64_t instrument_time() throw() {
+		return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+	}
+
+	inline const char* instrument_name(const instrument_counter aCounter) throw() {
+		static const char* const NAMES[INSTRUMENT_COUNTER_COUNT] = {
+			"matrix_multiply",
+			"vector_batch",
+			"reduce",
+			"sparse_multiply",
+			"solver",
+			"noise",
+			"hash",
+			"random",
+			"image"
+		};
+		return aCounter < INSTRUMENT_COUNTER_COUNT ? NAMES[aCounter] : "unknown";
+	}
+
+	//! \brief Adds one call, aElements elements and the elapsed cycles to the calling thread's counters on destruction
+	class instrument_scope {
+	private:
+		const uint64_t mElements;
+		const uint64_t mTime;
+		const uint64_t mCycles;
+		const instrument_counter mCounter;
+	private:
+		instrument_scope(const instrument_scope&) = delete;
+		instrument_scope& operator=(const instrument_scope&) = delete;
+	public:
+		instrument_scope(const instrument_counter aCounter, const uint64_t aElements) throw() :
+			mElements(aElements),
+			mTime(instrument_time()),
+			mCycles(instrument_cycles()),
+			mCounter(aCounter)
+		{}
+
+		~instrument_scope() {
+			solaire_instrument_record(mCounter, mElements, instrument_cycles() - mCycles, mTime, instrument_time());
+		}
+	};
+
+	//! \brief Per thread counters, including the combined counters of exited threads
+	inline void get_instrument_snapshot(std::vector<instrument_snapshot>& aSnapshot) {
+		uint32_t count = solaire_instrument_snapshot(nullptr, 0);
+		aSnapshot.resize(count);
+		count = solaire_instrument_snapshot(aSnapshot.data(), count);
+		aSnapshot.resize(count);
+	}
+
+	inline instrument_totals get_instrument_total(const instrument_counter aCounter) {
+		std::vector<instrument_snapshot> snapshot;
+		get_instrument_snapshot(snapshot);
+		instrument_totals tmp = {0, 0, 0};
+		for(const instrument_snapshot& i : snapshot) {
+			tmp.calls += i.counters[aCounter].calls;
+			tmp.elements += i.counters[aCounter].elements;
+			tmp.cycles += i.counters[aCounter].cycles;
+		}
+		return tmp;
+	}
+
+	inline void reset_instrument() {
+		solaire_instrument_reset();
+	}
+
+	//! \brief Record individual calls for write_instrument_trace, off by default
+	inline void set_instrument_trace(const bool aEnabled) {
+		solaire_instrument_set_trace(aEnabled);
+	}
+
+	//! \brief Write recorded calls as a Chrome trace (chrome://tracing, Perfetto) JSON file
+	inline bool write_instrument_trace(const char* const aPath) {
+		return solaire_instrument_write_trace(aPath);
+	}
+}
+
+#define SOLAIRE_INSTRUMENT_CONCAT2(aFirst, aSecond) aFirst ## aSecond
+#define SOLAIRE_INSTRUMENT_CONCAT(aFirst, aSecond) SOLAIRE_INSTRUMENT_CONCAT2(aFirst, aSecond)
+
+#if defined(SOLAIRE_MATHS_INSTRUMENT)
+	#define SOLAIRE_INSTRUMENT(aCounter, aElements) const solaire::instrument_scope SOLAIRE_INSTRUMENT_CONCAT(solaireInstrument, __LINE__)(aCounter, static_cast<uint64_t>(aElements))
+#else
+	#define SOLAIRE_INSTRUMENT(aCounter, aElements)
+#endif
+
+#endif
@@ -0,0 +1,192 @@
+#ifndef SOLAIRE_KD_TREE_HPP
+#define SOLAIRE_KD_TREE_HPP
+
+//Copyright 2016 Adam G. Smith
+//
+//Licensed under the Apache License, Version 2.0 (the "License");
+//you may not use this file except in compliance with the License.
+//You may obtain a copy of the License at
+//
+//http ://www.apache.org/licenses/LICENSE-2.0
+//
+//Unless required by applicable law or agreed to in writing, software
+//distributed under the License is distributed on an "AS IS" BASIS,
+//WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//See the License for the specific language governing permissions and
+//limitations under the License.
+
+#include <algorithm>
+#include <atomic>
+#include <vector>
+#include "solaire/maths/vector.hpp"
+#include "solaire/maths/parallel.hpp"
+
+namespace solaire {
+
+	//! \brief Balanced k-d tree over points for nearest neighbour and radius queries
+	//! \detail Points are copied in leaf order so each leaf is scanned contiguously.
+	//! The tree has no refit, build() reuses the storage of the previous build.
+	template<class T, const uint32_t S>
+	class kd_tree {
+	public:
+		typedef T type;
+		typedef vector<T,S> point_t;
+		enum {
+			LEAF_SIZE = 8,
+			PARALLEL_THRESHOLD = 16384,
+			INVALID = 0xFFFFFFFF
+		};
+	private:
+		struct node {
+			T split;
+			uint32_t axis;	//!< S for a leaf
+			uint32_t begin;
+			uint32_t end;
+			uint32_t left;
+			uint32_t right;
+		};
+
+		//! \brief A subtree left for the worker pool by the serial upper levels of a parallel build
+		struct build_task {
+			uint32_t* slot;	//!< Receives the subtree's root node
+			uint32_t begin;
+			uint32_t end;
+		};
+
+		std::vector<node> mNodes;
+		std::vector<point_t> mPoints;	//!< Points in leaf order
+		std::vector<uint32_t> mIndices;
+	private:
+		//! \param aTasks While not null, subtrees at aParallelDepth or below PARALLEL_THRESHOLD are queued instead of built
+		void _build(const point_t* const aPoints, std::atomic<uint32_t>& aNext, const uint32_t aBegin, const uint32_t aEnd, const uint32_t aDepth, const uint32_t aParallelDepth, uint32_t& aSlot, std::vector<build_task>* const aTasks) {
+			if(aTasks && (aDepth >= aParallelDepth || aEnd - aBegin <= PARALLEL_THRESHOLD)) {
+				const build_task task = {&aSlot, aBegin, aEnd};
+				aTasks->push_back(task);
+				return;
+			}
+
+			const uint32_t index = aNext++;
+			aSlot = index;
+			node& n = mNodes[index];
+			n.begin = aBegin;
+			n.end = aEnd;
+			n.left = INVALID;
+			n.right = INVALID;
+			n.axis = S;
+			n.split = static_cast<T>(0);
+			if(aEnd - aBegin <= LEAF_SIZE) return;
+
+			point_t lower = aPoints[mIndices[aBegin]];
+			point_t upper = lower;
+			for(uint32_t i = aBegin + 1; i < aEnd; ++i) {
+				const point_t& p = aPoints[mIndices[i]];
+				for(uint32_t j = 0; j < S; ++j) {
+					if(p[j] < lower[j]) lower[j] = p[j];
+					if(p[j] > upper[j]) upper[j] = p[j];
+				}
+			}
+			uint32_t axis = 0;
+			for(uint32_t i = 1; i < S; ++i) if(upper[i] - lower[i] > upper[axis] - lower[axis]) axis = i;
+
+			const uint32_t middle = aBegin + (aEnd - aBegin) / 2;
+			std::nth_element(mIndices.data() + aBegin, mIndices.data() + middle, mIndices.data() + aEnd, [&](const uint32_t a, const uint32_t b) {
+				return aPoints[a][axis] < aPoints[b][axis];
+			});
+			n.axis = axis;
+			n.split = aPoints[mIndices[middle]][axis];
+
+			_build(aPoints, aNext, aBegin, middle, aDepth + 1, aParallelDepth, n.left, aTasks);
+			_build(aPoints, aNext, middle, aEnd, aDepth + 1, aParallelDepth, n.right, aTasks);
+		}
+
+		void _nearest(const uint32_t aNode, const point_t& aPoint, const uint32_t aCount, uint32_t* const aIndices, T* const aDistances, uint32_t& aFound) const throw() {
+			const node& n = mNodes[aNode];
+			if(n.axis == S) {
+				for(uint32_t i = n.begin; i < n.end; ++i) {
+					const T distance = (mPoints[i] - aPoint).magnitude_sq();
+					if(aFound == aCount && ! (distance < aDistances[aCount - 1])) continue;
+
+					// Insertion into the sorted result list
+					uint32_t j = aFound < aCount ? aFound++ : aCount - 1;
+					while(j > 0 && aDistances[j - 1] > distance) {
+						aDistances[j] = aDistances[j - 1];
+						aIndices[j] = aIndices[j - 1];
+						--j;
+					}
+					aDistances[j] = distance;
+					aIndices[j] = mIndices[i];
+				}
+				return;
+			}
+
+			const T offset = aPoint[n.axis] - n.split;
+			_nearest(offset < static_cast<T>(0) ? n.left : n.right, aPoint, aCount, aIndices, aDistances, aFound);
+			if(aFound < aCount || offset * offset < aDistances[aCount - 1]) {
+				_nearest(offset < static_cast<T>(0) ? n.right : n.left, aPoint, aCount, aIndices, aDistances, aFound);
+			}
+		}
+
+		void _radius(const uint32_t aNode, const point_t& aPoint, const T aRadiusSq, std::vector<uint32_t>& aResults) const {
+			const node& n = mNodes[aNode];
+			if(n.axis == S) {
+				for(uint32_t i = n.begin; i < n.end; ++i) {
+					if((mPoints[i] - aPoint).magnitude_sq() <= aRadiusSq) aResults.push_back(mIndices[i]);
+				}
+				return;
+			}
+
+			const T offset = aPoint[n.axis] - n.split;
+			if(offset <= static_cast<T>(0) || offset * offset <= aRadiusSq) _radius(n.left, aPoint, aRadiusSq, aResults);
+			if(offset >= static_cast<T>(0) || offset * offset <= aRadiusSq) _radius(n.right, aPoint, aRadiusSq, aResults);
+		}
+	public:
+		kd_tree() {}
+
+		void build(const point_t* const aPoints, const uint32_t aCount) {
+			mIndices.resize(aCount);
+			mPoints.resize(aCount);
+			mNodes.clear();
+			if(aCount == 0) return;
+
+			for(uint32_t i = 0; i < aCount; ++i) mIndices[i] = i;
+			mNodes.resize(aCount * 2);
+			std::atomic<uint32_t> next(0);
+			uint32_t parallelDepth = 0;
+			for(uint32_t i = get_thread_count(); i > 1; i >>= 1) ++parallelDepth;
+
+			// The upper levels are split on this thread, the subtrees below them are built on the worker pool
+			uint32_t root;
+			std::vector<build_task> tasks;
+			_build(aPoints, next, 0, aCount, 0, parallelDepth, root, parallelDepth > 0 ? &tasks : nullptr);
+			parallel_for(static_cast<uint32_t>(tasks.size()), 1, [&](const uint32_t aBegin, const uint32_t aEnd) {
+				for(uint32_t i = aBegin; i < aEnd; ++i) _build(aPoints, next, tasks[i].begin, tasks[i].end, parallelDepth, parallelDepth, *tasks[i].slot, nullptr);
+			});
+			mNodes.resize(next);
+			for(uint32_t i = 0; i < aCount; ++i) mPoints[i] = aPoints[mIndices[i]];
+		}
+
+		//! \brief Find the aCount points closest to aPoint
+		//! \param aIndices Receives the point indices, nearest first
+		//! \param aDistances Receives the matching squared distances
+		//! \return The number of points found, less than aCount only if the tree is smaller
+		uint32_t nearest(const point_t& aPoint, const uint32_t aCount, uint32_t* const aIndices, T* const aDistances) const throw() {
+			uint32_t found = 0;
+			if(! mNodes.empty() && aCount > 0) _nearest(0, aPoint, aCount, aIndices, aDistances, found);
+			return found;
+		}
+
+		//! \brief Append the index of every point within aRadius of aPoint to aResults
+		void radius(const point_t& aPoint, const T aRadius, std::vector<uint32_t>& aResults) const {
+			if(! mNodes.empty()) _radius(0, aPoint, aRadius * aRadius, aResults);
+		}
+
+		inline uint32_t size() const throw() {
+			return static_cast<uint32_t>(mIndices.size());
+		}
+	};
+
+	typedef kd_tree<float, 2> kd_tree_2f;
+	typedef kd_tree<float, 3> kd_tree_3f;
+}
+
+#endif
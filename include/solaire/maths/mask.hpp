@@ -0,0 +1,138 @@
+#ifndef SOLAIRE_MASK_HPP
+#define SOLAIRE_MASK_HPP
+
+//Copyright 2016 Adam G. Smith
+//
+//Licensed under the Apache License, Version 2.0 (the "License");
+//you may not use this file except in compliance with the License.
+//You may obtain a copy of the License at
+//
+//http ://www.apache.org/licenses/LICENSE-2.0
+//
+//Unless required by applicable law or agreed to in writing, software
+//distributed under the License is distributed on an "AS IS" BASIS,
+//WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//See the License for the specific language governing permissions and
+//limitations under the License.
+
+#include <bitset>
+#include "solaire/maths/maths.hpp"
+
+namespace solaire {
+
+	template<class T, const uint32_t S>
+	class vector;
+
+	//! \brief Packed per-lane result of a vector comparison, lane i is bit i
+	template<const uint32_t S>
+	class vector_mask {
+	public:
+		typedef typename std::conditional<S <= 32, uint32_t, uint64_t>::type type;
+		enum{LENGTH = S};
+	private:
+		static_assert(S <= 64, "solaire::vector_mask : Length must be 64 or less");
+
+		static SOLAIRE_CONSTEXPR_I11 type full() throw() {
+			return S == sizeof(type) * 8 ? static_cast<type>(~static_cast<type>(0)) : static_cast<type>((static_cast<type>(1) << (S % (sizeof(type) * 8))) - 1);
+		}
+
+		type mBits;
+	public:
+		SOLAIRE_CONSTEXPR_11 vector_mask() throw() :
+			mBits(0)
+		{}
+
+		SOLAIRE_CONSTEXPR_11 explicit vector_mask(const type aBits) throw() :
+			mBits(aBits & full())
+		{}
+
+		SOLAIRE_CONSTEXPR_14 explicit vector_mask(const vector<bool, S>& aOther) throw() :
+			mBits(0)
+		{
+			for(uint32_t i = 0; i < S; ++i) mBits |= static_cast<type>(aOther[i]) << i;
+		}
+
+		SOLAIRE_CONSTEXPR_I11 bool operator[](const uint32_t aIndex) const throw() {
+			return ((mBits >> aIndex) & 1) != 0;
+		}
+
+		inline void set(const uint32_t aIndex, const bool aValue) throw() {
+			mBits = (mBits & ~(static_cast<type>(1) << aIndex)) | (static_cast<type>(aValue) << aIndex);
+		}
+
+		SOLAIRE_CONSTEXPR_I11 uint32_t size() const throw() {
+			return S;
+		}
+
+		SOLAIRE_CONSTEXPR_I11 type to_bitmask() const throw() {
+			return mBits;
+		}
+
+		SOLAIRE_CONSTEXPR_I11 bool any() const throw() {
+			return mBits != 0;
+		}
+
+		SOLAIRE_CONSTEXPR_I11 bool all() const throw() {
+			return mBits == full();
+		}
+
+		SOLAIRE_CONSTEXPR_I11 bool none() const throw() {
+			return mBits == 0;
+		}
+
+		inline uint32_t count() const throw() {
+			return static_cast<uint32_t>(std::bitset<sizeof(type) * 8>(mBits).count());
+		}
+
+		vector<bool, S> to_vector() const throw() {
+			vector<bool, S> tmp;
+			for(uint32_t i = 0; i < S; ++i) tmp[i] = operator[](i);
+			return tmp;
+		}
+
+		inline operator vector<bool, S>() const throw() {
+			return to_vector();
+		}
+
+		SOLAIRE_CONSTEXPR_I11 vector_mask<S> operator&(const vector_mask<S> aOther) const throw() {
+			return vector_mask<S>(mBits & aOther.mBits);
+		}
+
+		SOLAIRE_CONSTEXPR_I11 vector_mask<S> operator|(const vector_mask<S> aOther) const throw() {
+			return vector_mask<S>(mBits | aOther.mBits);
+		}
+
+		SOLAIRE_CONSTEXPR_I11 vector_mask<S> operator^(const vector_mask<S> aOther) const throw() {
+			return vector_mask<S>(mBits ^ aOther.mBits);
+		}
+
+		SOLAIRE_CONSTEXPR_I11 vector_mask<S> operator~() const throw() {
+			return vector_mask<S>(static_cast<type>(~mBits));
+		}
+
+		inline vector_mask<S>& operator&=(const vector_mask<S> aOther) throw() {
+			mBits &= aOther.mBits;
+			return *this;
+		}
+
+		inline vector_mask<S>& operator|=(const vector_mask<S> aOther) throw() {
+			mBits |= aOther.mBits;
+			return *this;
+		}
+
+		inline vector_mask<S>& operator^=(const vector_mask<S> aOther) throw() {
+			mBits ^= aOther.mBits;
+			return *this;
+		}
+
+		SOLAIRE_CONSTEXPR_I11 bool operator==(const vector_mask<S> aOther) const throw() {
+			return mBits == aOther.mBits;
+		}
+
+		SOLAIRE_CONSTEXPR_I11 bool operator!=(const vector_mask<S> aOther) const throw() {
+			return mBits != aOther.mBits;
+		}
+	};
+}
+
+#endif
\ No newline at end of file
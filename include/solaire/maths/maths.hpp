@@ -19,4 +19,34 @@
 
 #define SOLAIRE_MATHS
 
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+	#define SOLAIRE_MATHS_SSE2
+#endif
+
+#if defined(__SSSE3__) || defined(__AVX__)
+	#define SOLAIRE_MATHS_SSSE3
+#endif
+
+#if defined(__AVX__)
+	#define SOLAIRE_MATHS_AVX
+#endif
+
+#if defined(__AVX2__)
+	#define SOLAIRE_MATHS_AVX2
+#endif
+
+#if defined(__F16C__)
+	#define SOLAIRE_MATHS_F16C
+#endif
+
+#if defined(__FMA__)
+	#define SOLAIRE_MATHS_FMA
+#endif
+
+// Library wide options. These change inline and template code in the headers, so they must be set the same way
+// for the library and every translation unit that uses it, either here or on the command line of the whole build.
+
+// Record per thread kernel counters and call traces, see solaire/maths/instrument.hpp
+//#define SOLAIRE_MATHS_INSTRUMENT
+
 #endif
\ No newline at end of file
@@ -16,9 +16,15 @@
 //limitations under the License.
 
 #include "solaire/maths/vector.hpp"
+#include "solaire/maths/arena.hpp"
+#include "solaire/maths/instrument.hpp"
 
 namespace solaire {
 
+	enum {
+		MATRIX_STACK_BYTES = 1024	//!< Larger operation temporaries are taken from the thread arena
+	};
+
 	template<class T, const uint32_t W, const uint32_t H>
 	class matrix {
 	public:
@@ -84,20 +90,34 @@ namespace solaire {
 			return *this;
 		}
 
+	private:
 		template<const uint32_t W2, const uint32_t H2>
-		matrix<T,W,H>& operator*=(const matrix<T,W2,H2>& aOther) {
-			static_assert(W == H2, "solaire::matrix::operator* : Matrix dimension mismatch");
-			row_t rows[H];
-			column_t columns[W2];
-
-			for(uint32_t i = 0; i < H; ++i) rows[i] = get_row(i);
-			for(uint32_t i = 0; i < W2; ++i) columns[i] = aOther.get_column(i);
+		void _multiply(const matrix<T,W2,H2>& aOther, row_t* const aRows, vector<T,H2>* const aColumns) throw() {
+			for(uint32_t i = 0; i < H; ++i) aRows[i] = get_row(i);
+			for(uint32_t i = 0; i < W2; ++i) aColumns[i] = aOther.get_column(i);
 
 			for(uint32_t i = 0; i < H; ++i) {
 				for(uint32_t j = 0; j < W2; ++j) {
-					mElements[i * W + j] = rows[i].dot_product(columns[j]);
+					mElements[i * W + j] = aRows[i].dot_product(aColumns[j]);
 				}
 			}
+		}
+	public:
+		template<const uint32_t W2, const uint32_t H2>
+		matrix<T,W,H>& operator*=(const matrix<T,W2,H2>& aOther) {
+			static_assert(W == H2, "solaire::matrix::operator* : Matrix dimension mismatch");
+			SOLAIRE_INSTRUMENT(INSTRUMENT_MATRIX_MULTIPLY, H * W2);
+			enum {
+				STACK = (H * W + W2 * H2) * sizeof(T) <= MATRIX_STACK_BYTES
+			};
+			if(STACK) {
+				row_t rows[STACK ? H : 1];
+				vector<T,H2> columns[STACK ? W2 : 1];
+				_multiply(aOther, rows, columns);
+			}else {
+				arena_scope scope(get_thread_arena());
+				_multiply(aOther, scope.allocate<row_t>(H), scope.allocate<vector<T,H2>>(W2));
+			}
 			return *this;
 		}
 
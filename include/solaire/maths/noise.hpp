@@ -0,0 +1,378 @@
+#ifndef SOLAIRE_NOISE_HPP
+#define SOLAIRE_NOISE_HPP
+
+//Copyright 2016 Adam G. Smith
+//
+//Licensed under the Apache License, Version 2.0 (the "License");
+//you may not use this file except in compliance with the License.
+//You may obtain a copy of the License at
+//
+//http ://www.apache.org/licenses/LICENSE-2.0
+//
+//Unless required by applicable law or agreed to in writing, software
+//distributed under the License is distributed on an "AS IS" BASIS,
+//WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//See the License for the specific language governing permissions and
+//limitations under the License.
+
+#include <cmath>
+#include "solaire/maths/vector.hpp"
+#include "solaire/maths/parallel.hpp"
+#include "solaire/maths/instrument.hpp"
+
+namespace solaire {
+
+	enum noise_type : uint32_t {
+		NOISE_VALUE,		//!< Interpolated random lattice values
+		NOISE_GRADIENT,		//!< Perlin style interpolated random gradients
+		NOISE_SIMPLEX,		//!< Gradients summed over the corners of a simplex
+		NOISE_CELLULAR		//!< Distance to the nearest jittered feature point (Worley F1)
+	};
+}
+
+extern "C" SOLAIRE_EXPORT_API void SOLAIRE_EXPORT_CALL solaire_noise(const solaire::noise_type, const float* const*, float*, const uint32_t, const uint32_t, const uint32_t, const float, const float);
+
+namespace solaire {
+
+	enum : uint32_t {
+		NOISE_BLOCK = 256,
+		NOISE_PARALLEL_GRAIN = 16384
+	};
+
+	// Lattice hashing
+
+	//! \brief Per axis lattice multiplier, aAxis < 4
+	SOLAIRE_CONSTEXPR_I14 uint32_t noise_prime(const uint32_t aAxis) throw() {
+		const uint32_t primes[4] = {0x8DA6B343, 0xD8163841, 0xCB1AB31F, 0x165667B1};
+		return primes[aAxis];
+	}
+
+	//! \brief xorshift32* step, also used lane-wise by the SIMD kernels
+	SOLAIRE_CONSTEXPR_I14 uint32_t noise_mix(uint32_t aValue) throw() {
+		aValue ^= aValue << 13;
+		aValue ^= aValue >> 17;
+		aValue ^= aValue << 5;
+		return aValue * 0x2545F491;
+	}
+
+	template<const uint32_t S>
+	SOLAIRE_CONSTEXPR_I14 uint32_t noise_hash(const int32_t* const aCell, const uint32_t aSeed) throw() {
+		uint32_t h = aSeed * 0x9E3779B1;
+		for(uint32_t i = 0; i < S; ++i) h ^= static_cast<uint32_t>(aCell[i]) * noise_prime(i);
+		return noise_mix(h);
+	}
+
+	//! \brief aFirst * aSecond + aAdd, fused explicitly when the target has FMA so the scalar and AVX2 paths round the same way
+	template<class T>
+	inline T _noise_madd(const T aFirst, const T aSecond, const T aAdd) throw() {
+		#if defined(SOLAIRE_MATHS_FMA)
+			return std::fma(aFirst, aSecond, aAdd);
+		#else
+			return aFirst * aSecond + aAdd;
+		#endif
+	}
+
+	//! \brief Component i of a corner gradient, uniform in [-1, 1]
+	template<class T>
+	inline T _noise_gradient(const uint32_t aHash, const uint32_t aIndex) throw() {
+		return _noise_madd(static_cast<T>((aHash >> (aIndex * 8)) & 0xFF), static_cast<T>(1.0 / 127.5), static_cast<T>(-1));
+	}
+
+	template<class T>
+	inline T _noise_fade(const T aValue) throw() {
+		return aValue * aValue * aValue * _noise_madd(aValue, _noise_madd(aValue, static_cast<T>(6), static_cast<T>(-15)), static_cast<T>(10));
+	}
+
+	//! \brief Measured scales that bring gradient and simplex noise into roughly [-1, 1]
+	template<class T>
+	SOLAIRE_CONSTEXPR_I11 T _noise_scale(const noise_type aType, const uint32_t aDimensions) throw() {
+		return static_cast<T>(
+			aType == NOISE_GRADIENT ? (aDimensions == 1 ? 2.0 : aDimensions == 2 ? 1.4 : aDimensions == 3 ? 1.27 : 1.15) :
+			aType == NOISE_SIMPLEX ? (aDimensions == 1 ? 70.0 : aDimensions == 2 ? 72.0 : aDimensions == 3 ? 29.0 : 27.0) :
+			1.0
+		);
+	}
+
+	// Scalar evaluation
+
+	template<class T, const uint32_t S>
+	T value_noise(const vector<T,S>& aPoint, const uint32_t aSeed) throw() {
+		static_assert(S >= 1 && S <= 4, "solaire::value_noise : Only 1 to 4 dimensions are supported");
+		int32_t cell[S];
+		T weight[S];
+		for(uint32_t i = 0; i < S; ++i) {
+			const T base = std::floor(aPoint[i]);
+			cell[i] = static_cast<int32_t>(base);
+			weight[i] = _noise_fade(aPoint[i] - base);
+		}
+
+		// Multilinear interpolation written as a weighted sum over the 2^S corners
+		T result = static_cast<T>(0);
+		for(uint32_t c = 0; c < (1u << S); ++c) {
+			int32_t corner[S];
+			T w = static_cast<T>(1);
+			for(uint32_t i = 0; i < S; ++i) {
+				const uint32_t bit = (c >> i) & 1;
+				corner[i] = cell[i] + static_cast<int32_t>(bit);
+				w *= bit ? weight[i] : static_cast<T>(1) - weight[i];
+			}
+			result = _noise_madd(w, _noise_madd(static_cast<T>(noise_hash<S>(corner, aSeed) >> 8), static_cast<T>(1.0 / 8388608.0), static_cast<T>(-1)), result);
+		}
+		return result;
+	}
+
+	template<class T, const uint32_t S>
+	T gradient_noise(const vector<T,S>& aPoint, const uint32_t aSeed) throw() {
+		static_assert(S >= 1 && S <= 4, "solaire::gradient_noise : Only 1 to 4 dimensions are supported");
+		int32_t cell[S];
+		T offset[S];
+		T weight[S];
+		for(uint32_t i = 0; i < S; ++i) {
+			const T base = std::floor(aPoint[i]);
+			cell[i] = static_cast<int32_t>(base);
+			offset[i] = aPoint[i] - base;
+			weight[i] = _noise_fade(offset[i]);
+		}
+
+		T result = static_cast<T>(0);
+		for(uint32_t c = 0; c < (1u << S); ++c) {
+			int32_t corner[S];
+			T w = static_cast<T>(1);
+			for(uint32_t i = 0; i < S; ++i) {
+				const uint32_t bit = (c >> i) & 1;
+				corner[i] = cell[i] + static_cast<int32_t>(bit);
+				w *= bit ? weight[i] : static_cast<T>(1) - weight[i];
+			}
+			const uint32_t h = noise_hash<S>(corner, aSeed);
+			T d = static_cast<T>(0);
+			for(uint32_t i = 0; i < S; ++i) d = _noise_madd(_noise_gradient<T>(h, i), offset[i] - static_cast<T>((c >> i) & 1), d);
+			result = _noise_madd(w, d, result);
+		}
+		return result * _noise_scale<T>(NOISE_GRADIENT, S);
+	}
+
+	template<class T, const uint32_t S>
+	T simplex_noise(const vector<T,S>& aPoint, const uint32_t aSeed) throw() {
+		static_assert(S >= 1 && S <= 4, "solaire::simplex_noise : Only 1 to 4 dimensions are supported");
+		const T root = std::sqrt(static_cast<T>(S + 1));
+		const T skew = (root - static_cast<T>(1)) / static_cast<T>(S);
+		const T unskew = (static_cast<T>(1) - static_cast<T>(1) / root) / static_cast<T>(S);
+		const T radius = static_cast<T>(S <= 2 ? 0.5 : 0.6);
+
+		// Skew into the simplex lattice and find the containing cell
+		T s = static_cast<T>(0);
+		for(uint32_t i = 0; i < S; ++i) s += aPoint[i];
+		s *= skew;
+		int32_t cell[S];
+		T t = static_cast<T>(0);
+		for(uint32_t i = 0; i < S; ++i) {
+			cell[i] = static_cast<int32_t>(std::floor(aPoint[i] + s));
+			t += static_cast<T>(cell[i]);
+		}
+		t *= unskew;
+		T offset[S];
+		for(uint32_t i = 0; i < S; ++i) offset[i] = aPoint[i] - (static_cast<T>(cell[i]) - t);
+
+		// Corners are visited by stepping along axes in order of decreasing offset
+		uint32_t order[S];
+		for(uint32_t i = 0; i < S; ++i) order[i] = i;
+		for(uint32_t i = 1; i < S; ++i) {
+			for(uint32_t j = i; j > 0 && offset[order[j]] > offset[order[j - 1]]; --j) {
+				const uint32_t tmp = order[j];
+				order[j] = order[j - 1];
+				order[j - 1] = tmp;
+			}
+		}
+
+		T result = static_cast<T>(0);
+		int32_t corner[S];
+		uint32_t steps[S];
+		for(uint32_t i = 0; i < S; ++i) {
+			corner[i] = cell[i];
+			steps[i] = 0;
+		}
+		for(uint32_t k = 0; k <= S; ++k) {
+			if(k > 0) {
+				++corner[order[k - 1]];
+				++steps[order[k - 1]];
+			}
+			T d[S];
+			T distance = static_cast<T>(0);
+			for(uint32_t i = 0; i < S; ++i) {
+				d[i] = offset[i] - static_cast<T>(steps[i]) + static_cast<T>(k) * unskew;
+				distance += d[i] * d[i];
+			}
+			T falloff = radius - distance;
+			if(falloff <= static_cast<T>(0)) continue;
+			falloff *= falloff;
+			const uint32_t h = noise_hash<S>(corner, aSeed);
+			T g = static_cast<T>(0);
+			for(uint32_t i = 0; i < S; ++i) g += _noise_gradient<T>(h, i) * d[i];
+			result += falloff * falloff * g;
+		}
+		return result * _noise_scale<T>(NOISE_SIMPLEX, S);
+	}
+
+	//! \return Distance to the nearest feature point in cell units, in [0, sqrt(S)]
+	template<class T, const uint32_t S>
+	T cellular_noise(const vector<T,S>& aPoint, const uint32_t aSeed) throw() {
+		static_assert(S >= 1 && S <= 4, "solaire::cellular_noise : Only 1 to 4 dimensions are supported");
+		int32_t cell[S];
+		T offset[S];
+		for(uint32_t i = 0; i < S; ++i) {
+			const T base = std::floor(aPoint[i]);
+			cell[i] = static_cast<int32_t>(base);
+			offset[i] = aPoint[i] - base;
+		}
+
+		// One feature point per cell, search the 3^S neighbourhood
+		uint32_t neighbours = 1;
+		for(uint32_t i = 0; i < S; ++i) neighbours *= 3;
+		T best = static_cast<T>(S + 1);
+		for(uint32_t n = 0; n < neighbours; ++n) {
+			int32_t corner[S];
+			int32_t step[S];
+			uint32_t tmp = n;
+			for(uint32_t i = 0; i < S; ++i) {
+				step[i] = static_cast<int32_t>(tmp % 3) - 1;
+				corner[i] = cell[i] + step[i];
+				tmp /= 3;
+			}
+			const uint32_t h = noise_hash<S>(corner, aSeed);
+			T distance = static_cast<T>(0);
+			for(uint32_t i = 0; i < S; ++i) {
+				const T d = static_cast<T>(step[i]) + static_cast<T>((h >> (i * 8)) & 0xFF) * static_cast<T>(1.0 / 256.0) - offset[i];
+				distance += d * d;
+			}
+			if(distance < best) best = distance;
+		}
+		return std::sqrt(best);
+	}
+
+	template<const noise_type N, class T, const uint32_t S>
+	inline T noise(const vector<T,S>& aPoint, const uint32_t aSeed) throw() {
+		return
+			N == NOISE_VALUE ? value_noise(aPoint, aSeed) :
+			N == NOISE_GRADIENT ? gradient_noise(aPoint, aSeed) :
+			N == NOISE_SIMPLEX ? simplex_noise(aPoint, aSeed) :
+			cellular_noise(aPoint, aSeed);
+	}
+
+	//! \brief Fractal Brownian motion, octave i is sampled at lacunarity^i with amplitude gain^i and seed + i
+	template<const noise_type N, class T, const uint32_t S>
+	T fbm(const vector<T,S>& aPoint, const uint32_t aSeed, const uint32_t aOctaves, const T aLacunarity = static_cast<T>(2), const T aGain = static_cast<T>(0.5)) throw() {
+		T result = static_cast<T>(0);
+		T frequency = static_cast<T>(1);
+		T amplitude = static_cast<T>(1);
+		for(uint32_t i = 0; i < aOctaves; ++i) {
+			result = _noise_madd(noise<N>(aPoint * frequency, aSeed + i), amplitude, result);
+			frequency *= aLacunarity;
+			amplitude *= aGain;
+		}
+		return result;
+	}
+
+	//! \brief Scalar kernel behind solaire_noise, aOutput[i] += noise(point[i] * aFrequency) * aAmplitude
+	template<const uint32_t S>
+	void _noise_accumulate(const noise_type aType, const float* const* const aComponents, float* const aOutput, const uint32_t aCount, const uint32_t aSeed, const float aFrequency, const float aAmplitude) throw() {
+		for(uint32_t i = 0; i < aCount; ++i) {
+			vector<float,S> p;
+			for(uint32_t j = 0; j < S; ++j) p[j] = aComponents[j][i] * aFrequency;
+			float n;
+			switch(aType) {
+			case NOISE_VALUE:
+				n = value_noise(p, aSeed);
+				break;
+			case NOISE_GRADIENT:
+				n = gradient_noise(p, aSeed);
+				break;
+			case NOISE_SIMPLEX:
+				n = simplex_noise(p, aSeed);
+				break;
+			default:
+				n = cellular_noise(p, aSeed);
+				break;
+			}
+			aOutput[i] = _noise_madd(n, aAmplitude, aOutput[i]);
+		}
+	}
+
+	// Batch evaluation
+
+	//! \brief Evaluate fBm for SoA points, aComponents holds S arrays of aCount coordinates
+	template<const noise_type N, const uint32_t S>
+	void noise_all(const float* const* const aComponents, float* const aOutput, const uint32_t aCount, const uint32_t aSeed, const uint32_t aOctaves = 1, const float aLacunarity = 2.f, const float aGain = 0.5f) {
+		static_assert(S >= 1 && S <= 4, "solaire::noise_all : Only 1 to 4 dimensions are supported");
+		SOLAIRE_INSTRUMENT(INSTRUMENT_NOISE, static_cast<uint64_t>(aCount) * aOctaves);
+		parallel_for(aCount, NOISE_PARALLEL_GRAIN, [=](const uint32_t aBegin, const uint32_t aEnd) {
+			const float* components[S];
+			for(uint32_t j = 0; j < S; ++j) components[j] = aComponents[j] + aBegin;
+			for(uint32_t i = aBegin; i < aEnd; ++i) aOutput[i] = 0.f;
+			float frequency = 1.f;
+			float amplitude = 1.f;
+			for(uint32_t i = 0; i < aOctaves; ++i) {
+				solaire_noise(N, components, aOutput + aBegin, aEnd - aBegin, S, aSeed + i, frequency, amplitude);
+				frequency *= aLacunarity;
+				amplitude *= aGain;
+			}
+		});
+	}
+
+	//! \brief Evaluate fBm for AoS points
+	template<const noise_type N, const uint32_t S>
+	void noise_all(const vector<float,S>* const aPoints, float* const aOutput, const uint32_t aCount, const uint32_t aSeed, const uint32_t aOctaves = 1, const float aLacunarity = 2.f, const float aGain = 0.5f) {
+		SOLAIRE_INSTRUMENT(INSTRUMENT_NOISE, static_cast<uint64_t>(aCount) * aOctaves);
+		parallel_for(aCount, NOISE_PARALLEL_GRAIN, [=](const uint32_t aBegin, const uint32_t aEnd) {
+			float soa[S][NOISE_BLOCK];
+			const float* components[S];
+			for(uint32_t j = 0; j < S; ++j) components[j] = soa[j];
+			for(uint32_t i = aBegin; i < aEnd; i += NOISE_BLOCK) {
+				const uint32_t count = aEnd - i < NOISE_BLOCK ? aEnd - i : static_cast<uint32_t>(NOISE_BLOCK);
+				for(uint32_t k = 0; k < count; ++k) {
+					aOutput[i + k] = 0.f;
+					for(uint32_t j = 0; j < S; ++j) soa[j][k] = aPoints[i + k][j];
+				}
+				float frequency = 1.f;
+				float amplitude = 1.f;
+				for(uint32_t o = 0; o < aOctaves; ++o) {
+					solaire_noise(N, components, aOutput + i, count, S, aSeed + o, frequency, amplitude);
+					frequency *= aLacunarity;
+					amplitude *= aGain;
+				}
+			}
+		});
+	}
+
+	//! \brief Fill a row major aWidth x aHeight grid sampled at aOrigin + (x, y) * aStep
+	template<const noise_type N>
+	void noise_grid(float* const aOutput, const uint32_t aWidth, const uint32_t aHeight, const vector<float,2>& aOrigin, const float aStep, const uint32_t aSeed, const uint32_t aOctaves = 1, const float aLacunarity = 2.f, const float aGain = 0.5f) {
+		SOLAIRE_INSTRUMENT(INSTRUMENT_NOISE, static_cast<uint64_t>(aWidth) * aHeight * aOctaves);
+		const vector<float,2> origin = aOrigin;
+		const uint32_t grain = aWidth >= NOISE_PARALLEL_GRAIN ? 1 : NOISE_PARALLEL_GRAIN / (aWidth == 0 ? 1 : aWidth);
+		parallel_for(aHeight, grain, [=](const uint32_t aBegin, const uint32_t aEnd) {
+			float x[NOISE_BLOCK];
+			float y[NOISE_BLOCK];
+			const float* components[2] = {x, y};
+			for(uint32_t row = aBegin; row < aEnd; ++row) {
+				float* const output = aOutput + static_cast<size_t>(row) * aWidth;
+				for(uint32_t k = 0; k < NOISE_BLOCK; ++k) y[k] = origin[1] + static_cast<float>(row) * aStep;
+				for(uint32_t i = 0; i < aWidth; i += NOISE_BLOCK) {
+					const uint32_t count = aWidth - i < NOISE_BLOCK ? aWidth - i : static_cast<uint32_t>(NOISE_BLOCK);
+					for(uint32_t k = 0; k < count; ++k) {
+						x[k] = origin[0] + static_cast<float>(i + k) * aStep;
+						output[i + k] = 0.f;
+					}
+					float frequency = 1.f;
+					float amplitude = 1.f;
+					for(uint32_t o = 0; o < aOctaves; ++o) {
+						solaire_noise(N, components, output + i, count, 2, aSeed + o, frequency, amplitude);
+						frequency *= aLacunarity;
+						amplitude *= aGain;
+					}
+				}
+			}
+		});
+	}
+}
+
+#endif
@@ -0,0 +1,77 @@
+#ifndef SOLAIRE_PARALLEL_HPP
+#define SOLAIRE_PARALLEL_HPP
+
+//Copyright 2016 Adam G. Smith
+//
+//Licensed under the Apache License, Version 2.0 (the "License");
+//you may not use this file except in compliance with the License.
+//You may obtain a copy of the License at
+//
+//http ://www.apache.org/licenses/LICENSE-2.0
+//
+//Unless required by applicable law or agreed to in writing, software
+//distributed under the License is distributed on an "AS IS" BASIS,
+//WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//See the License for the specific language governing permissions and
+//limitations under the License.
+
+#include "solaire/maths/maths.hpp"
+
+extern "C" SOLAIRE_EXPORT_API void SOLAIRE_EXPORT_CALL solaire_set_thread_count(const uint32_t);
+extern "C" SOLAIRE_EXPORT_API uint32_t SOLAIRE_EXPORT_CALL solaire_get_thread_count();
+extern "C" SOLAIRE_EXPORT_API void SOLAIRE_EXPORT_CALL solaire_parallel_run(const uint32_t, const uint32_t, const uint32_t, void(*)(const void*, const uint32_t, const uint32_t), const void*);
+
+namespace solaire {
+
+	//! \brief Lets callers that already run in parallel, or on small problems, keep a kernel on the calling thread
+	enum execution : uint32_t {
+		EXECUTION_SERIAL,
+		EXECUTION_PARALLEL
+	};
+
+	//! \brief Set the maximum number of threads used by parallel maths kernels, 0 uses the hardware concurrency
+	inline void set_thread_count(const uint32_t aCount) {
+		solaire_set_thread_count(aCount);
+	}
+
+	inline uint32_t get_thread_count() {
+		return solaire_get_thread_count();
+	}
+
+	template<class F>
+	void _parallel_invoke(const void* const aFunction, const uint32_t aBegin, const uint32_t aEnd) {
+		(*static_cast<const F*>(aFunction))(aBegin, aEnd);
+	}
+
+	//! \brief Split [0, aCount) into one contiguous range per thread and call aFunction(begin, end) on each
+	//! \detail Ranges are never smaller than aGrain. They run on a persistent worker pool that is started on first use,
+	//! so steady state calls neither create threads nor allocate. Calls made while the pool is busy, including
+	//! nested calls from inside aFunction, run on the calling thread.
+	template<class F>
+	void parallel_for(const uint32_t aCount, const uint32_t aGrain, const F& aFunction) {
+		if(aCount == 0) return;
+		const uint32_t grain = aGrain == 0 ? 1 : aGrain;
+		uint32_t threads = get_thread_count();
+		const uint32_t maxThreads = (aCount + grain - 1) / grain;
+		if(threads > maxThreads) threads = maxThreads;
+
+		if(threads <= 1) {
+			aFunction(static_cast<uint32_t>(0), aCount);
+			return;
+		}
+
+		const uint32_t chunk = (aCount + threads - 1) / threads;
+		solaire_parallel_run(aCount, chunk, threads, &_parallel_invoke<F>, &aFunction);
+	}
+
+	template<class F>
+	inline void parallel_for(const execution aExecution, const uint32_t aCount, const uint32_t aGrain, const F& aFunction) {
+		if(aExecution == EXECUTION_SERIAL) {
+			if(aCount > 0) aFunction(static_cast<uint32_t>(0), aCount);
+		}else {
+			parallel_for(aCount, aGrain, aFunction);
+		}
+	}
+}
+
+#endif
@@ -0,0 +1,275 @@
+#ifndef SOLAIRE_RANDOM_TEST_HPP
+#define SOLAIRE_RANDOM_TEST_HPP
+
+//Copyright 2016 Adam G. Smith
+//
+//Licensed under the Apache License, Version 2.0 (the "License");
+//you may not use this file except in compliance with the License.
+//You may obtain a copy of the License at
+//
+//http ://www.apache.org/licenses/LICENSE-2.0
+//
+//Unless required by applicable law or agreed to in writing, software
+//distributed under the License is distributed on an "AS IS" BASIS,
+//WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//See the License for the specific language governing permissions and
+//limitations under the License.
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <vector>
+#include "solaire/maths/randomiser.hpp"
+
+namespace solaire {
+
+	struct random_test_result {
+		const char* name;
+		double statistic;
+		double p_value;
+		bool passed;	//!< p_value is inside [RANDOM_TEST_ALPHA, 1 - RANDOM_TEST_ALPHA]
+	};
+
+	struct random_benchmark_result {
+		double per_value;	//!< Values per second through next_d
+		double bulk;		//!< Values per second through fill
+	};
+
+	enum : uint32_t {
+		RANDOM_TEST_BLOCK = 4096,
+		RANDOM_BATTERY_SIZE = 6
+	};
+
+	static SOLAIRE_CONSTEXPR_11 double RANDOM_TEST_ALPHA = 0.001;
+
+	// Distributions
+
+	//! \brief Upper regularised incomplete gamma function Q(a, x)
+	inline double incomplete_gamma_q(const double aA, const double aX) throw() {
+		if(aX <= 0.0) return 1.0;
+		const double prefix = std::exp(-aX + aA * std::log(aX) - std::lgamma(aA));
+		if(aX < aA + 1.0) {
+			// Series for P(a, x)
+			double term = 1.0 / aA;
+			double sum = term;
+			for(double n = aA + 1.0; n < aA + 100000.0; n += 1.0) {
+				term *= aX / n;
+				sum += term;
+				if(std::abs(term) < std::abs(sum) * 1e-15) break;
+			}
+			return 1.0 - sum * prefix;
+		}else {
+			// Lentz continued fraction for Q(a, x)
+			const double tiny = 1e-300;
+			double b = aX + 1.0 - aA;
+			double c = 1.0 / tiny;
+			double d = 1.0 / b;
+			double h = d;
+			for(double i = 1.0; i < 100000.0; i += 1.0) {
+				const double an = -i * (i - aA);
+				b += 2.0;
+				d = an * d + b;
+				if(std::abs(d) < tiny) d = tiny;
+				c = b + an / c;
+				if(std::abs(c) < tiny) c = tiny;
+				d = 1.0 / d;
+				const double delta = d * c;
+				h *= delta;
+				if(std::abs(delta - 1.0) < 1e-15) break;
+			}
+			return prefix * h;
+		}
+	}
+
+	//! \brief Probability of a chi-square statistic at least this large
+	inline double chi_square_p(const double aStatistic, const double aDegreesOfFreedom) throw() {
+		return incomplete_gamma_q(aDegreesOfFreedom * 0.5, aStatistic * 0.5);
+	}
+
+	inline double chi_square(const uint64_t* const aObserved, const double* const aExpected, const uint32_t aBins) throw() {
+		double tmp = 0.0;
+		for(uint32_t i = 0; i < aBins; ++i) {
+			const double d = static_cast<double>(aObserved[i]) - aExpected[i];
+			tmp += d * d / aExpected[i];
+		}
+		return tmp;
+	}
+
+	inline random_test_result _random_result(const char* const aName, const double aStatistic, const double aP) throw() {
+		random_test_result tmp;
+		tmp.name = aName;
+		tmp.statistic = aStatistic;
+		tmp.p_value = aP;
+		tmp.passed = aP >= RANDOM_TEST_ALPHA && aP <= 1.0 - RANDOM_TEST_ALPHA;
+		return tmp;
+	}
+
+	//! \brief Pulls values from a randomiser through the bulk interface in fixed blocks
+	class random_stream {
+	private:
+		randomiser& mRandomiser;
+		double mBuffer[RANDOM_TEST_BLOCK];
+		uint32_t mPosition;
+	public:
+		explicit random_stream(randomiser& aRandomiser) :
+			mRandomiser(aRandomiser),
+			mPosition(RANDOM_TEST_BLOCK)
+		{}
+
+		inline double next() throw() {
+			if(mPosition == RANDOM_TEST_BLOCK) {
+				mRandomiser.fill(mBuffer, RANDOM_TEST_BLOCK);
+				mPosition = 0;
+			}
+			return mBuffer[mPosition++];
+		}
+
+		inline uint32_t next(const uint32_t aRange) throw() {
+			const uint32_t tmp = static_cast<uint32_t>(next() * static_cast<double>(aRange));
+			return tmp < aRange ? tmp : aRange - 1;
+		}
+	};
+
+	// Tests
+
+	//! \brief Chi-square test of values falling into aBins equal bins
+	inline random_test_result test_uniformity(randomiser& aRandomiser, const uint32_t aSamples = 1 << 20, const uint32_t aBins = 256) {
+		random_stream stream(aRandomiser);
+		std::vector<uint64_t> observed(aBins, 0);
+		std::vector<double> expected(aBins, static_cast<double>(aSamples) / aBins);
+		for(uint32_t i = 0; i < aSamples; ++i) ++observed[stream.next(aBins)];
+		const double x = chi_square(observed.data(), expected.data(), aBins);
+		return _random_result("uniformity", x, chi_square_p(x, aBins - 1));
+	}
+
+	//! \brief Chi-square test of non-overlapping pairs on an aBins x aBins grid, detects correlation between successive values
+	inline random_test_result test_serial(randomiser& aRandomiser, const uint32_t aPairs = 1 << 20, const uint32_t aBins = 64) {
+		random_stream stream(aRandomiser);
+		const uint32_t cells = aBins * aBins;
+		std::vector<uint64_t> observed(cells, 0);
+		std::vector<double> expected(cells, static_cast<double>(aPairs) / cells);
+		for(uint32_t i = 0; i < aPairs; ++i) {
+			const uint32_t a = stream.next(aBins);
+			++observed[a * aBins + stream.next(aBins)];
+		}
+		const double x = chi_square(observed.data(), expected.data(), cells);
+		return _random_result("serial", x, chi_square_p(x, cells - 1));
+	}
+
+	//! \brief Knuth's gap test, lengths of runs between values in [aLower, aUpper) are geometric
+	inline random_test_result test_gap(randomiser& aRandomiser, const uint32_t aGaps = 1 << 18, const double aLower = 0.0, const double aUpper = 0.5, const uint32_t aMaxGap = 16) {
+		random_stream stream(aRandomiser);
+		const double p = aUpper - aLower;
+		std::vector<uint64_t> observed(aMaxGap + 1, 0);
+		std::vector<double> expected(aMaxGap + 1);
+		for(uint32_t i = 0; i < aMaxGap; ++i) expected[i] = aGaps * p * std::pow(1.0 - p, static_cast<double>(i));
+		expected[aMaxGap] = aGaps * std::pow(1.0 - p, static_cast<double>(aMaxGap));
+
+		for(uint32_t i = 0; i < aGaps; ++i) {
+			uint32_t gap = 0;
+			while(true) {
+				const double u = stream.next();
+				if(u >= aLower && u < aUpper) break;
+				++gap;
+			}
+			++observed[gap < aMaxGap ? gap : aMaxGap];
+		}
+		const double x = chi_square(observed.data(), expected.data(), aMaxGap + 1);
+		return _random_result("gap", x, chi_square_p(x, aMaxGap));
+	}
+
+	//! \brief Marsaglia's birthday spacings, repeated duplicate spacing counts are Poisson with mean m^3 / 4n
+	inline random_test_result test_birthday_spacing(randomiser& aRandomiser, const uint32_t aRepeats = 512, const uint32_t aBirthdays = 1024, const uint32_t aDayBits = 27) {
+		random_stream stream(aRandomiser);
+		const double days = std::ldexp(1.0, static_cast<int>(aDayBits));
+		const double lambda = std::pow(static_cast<double>(aBirthdays), 3.0) / (4.0 * days);
+		std::vector<uint64_t> birthdays(aBirthdays);
+		uint64_t duplicates = 0;
+		for(uint32_t r = 0; r < aRepeats; ++r) {
+			for(uint64_t& i : birthdays) i = static_cast<uint64_t>(stream.next() * days);
+			std::sort(birthdays.begin(), birthdays.end());
+			for(uint32_t i = aBirthdays - 1; i > 0; --i) birthdays[i] -= birthdays[i - 1];
+			std::sort(birthdays.begin(), birthdays.end());
+			for(uint32_t i = 1; i < aBirthdays; ++i) if(birthdays[i] == birthdays[i - 1]) ++duplicates;
+		}
+
+		// Normal approximation to the Poisson total
+		const double mean = lambda * aRepeats;
+		const double z = (static_cast<double>(duplicates) - mean) / std::sqrt(mean);
+		return _random_result("birthday_spacing", static_cast<double>(duplicates), 1.0 - 0.5 * std::erfc(-z / std::sqrt(2.0)));
+	}
+
+	//! \brief The maximum of aT uniform values raised to the power aT is uniform
+	inline random_test_result test_maximum_of_t(randomiser& aRandomiser, const uint32_t aGroups = 1 << 18, const uint32_t aT = 8, const uint32_t aBins = 128) {
+		random_stream stream(aRandomiser);
+		std::vector<uint64_t> observed(aBins, 0);
+		std::vector<double> expected(aBins, static_cast<double>(aGroups) / aBins);
+		for(uint32_t i = 0; i < aGroups; ++i) {
+			double m = 0.0;
+			for(uint32_t j = 0; j < aT; ++j) m = std::max(m, stream.next());
+			const uint32_t bin = static_cast<uint32_t>(std::pow(m, static_cast<double>(aT)) * aBins);
+			++observed[bin < aBins ? bin : aBins - 1];
+		}
+		const double x = chi_square(observed.data(), expected.data(), aBins);
+		return _random_result("maximum_of_t", x, chi_square_p(x, aBins - 1));
+	}
+
+	//! \brief Each of the 32 most significant bits should be set half of the time
+	inline random_test_result test_bit_frequency(randomiser& aRandomiser, const uint32_t aSamples = 1 << 20) {
+		random_stream stream(aRandomiser);
+		uint64_t counts[32] = {};
+		for(uint32_t i = 0; i < aSamples; ++i) {
+			const uint32_t bits = static_cast<uint32_t>(stream.next() * 4294967296.0);
+			for(uint32_t j = 0; j < 32; ++j) counts[j] += (bits >> j) & 1;
+		}
+		double x = 0.0;
+		const double half = aSamples * 0.5;
+		for(uint32_t j = 0; j < 32; ++j) {
+			const double d = static_cast<double>(counts[j]) - half;
+			x += d * d / (half * 0.5);
+		}
+		return _random_result("bit_frequency", x, chi_square_p(x, 32.0));
+	}
+
+	//! \brief Run every test with its default parameters
+	//! \return The number of failed tests
+	inline uint32_t run_random_battery(randomiser& aRandomiser, random_test_result (&aResults)[RANDOM_BATTERY_SIZE]) {
+		aResults[0] = test_uniformity(aRandomiser);
+		aResults[1] = test_serial(aRandomiser);
+		aResults[2] = test_gap(aRandomiser);
+		aResults[3] = test_birthday_spacing(aRandomiser);
+		aResults[4] = test_maximum_of_t(aRandomiser);
+		aResults[5] = test_bit_frequency(aRandomiser);
+		uint32_t failed = 0;
+		for(const random_test_result& i : aResults) if(! i.passed) ++failed;
+		return failed;
+	}
+
+	// Throughput
+
+	inline random_benchmark_result benchmark_randomiser(randomiser& aRandomiser, const uint32_t aCount = 1 << 24) {
+		typedef std::chrono::high_resolution_clock clock;
+		random_benchmark_result result;
+		double sink = 0.0;
+
+		clock::time_point begin = clock::now();
+		for(uint32_t i = 0; i < aCount; ++i) sink += aRandomiser.next_d(0.0, 1.0);
+		result.per_value = aCount / std::chrono::duration<double>(clock::now() - begin).count();
+
+		double buffer[RANDOM_TEST_BLOCK];
+		begin = clock::now();
+		for(uint32_t i = 0; i < aCount; i += RANDOM_TEST_BLOCK) {
+			const uint32_t count = aCount - i < RANDOM_TEST_BLOCK ? aCount - i : static_cast<uint32_t>(RANDOM_TEST_BLOCK);
+			aRandomiser.fill(buffer, count);
+			sink += buffer[0];
+		}
+		result.bulk = aCount / std::chrono::duration<double>(clock::now() - begin).count();
+
+		// Keep the generated values observable so the loops are not removed
+		volatile double keep = sink;
+		(void) keep;
+		return result;
+	}
+}
+
+#endif
@@ -16,11 +16,18 @@
 //limitations under the License.
 
 #include "solaire/maths/maths.hpp"
+#include "solaire/maths/instrument.hpp"
 
 namespace solaire {
 	SOLAIRE_EXPORT_INTERFACE randomiser{
 	protected:
+		//! \return A value in [0, 1)
 		virtual SOLAIRE_INTERFACE_CALL double random_normal() throw() = 0;
+
+		//! \brief Bulk version of random_normal, override to avoid a virtual call per value
+		virtual void SOLAIRE_INTERFACE_CALL random_normal_all(double* const aOutput, const uint32_t aCount) throw() {
+			for(uint32_t i = 0; i < aCount; ++i) aOutput[i] = random_normal();
+		}
 	public:
 		virtual SOLAIRE_INTERFACE_CALL ~randomiser() throw() {}
 
@@ -32,13 +39,23 @@ namespace solaire {
 		}
 
 		inline double next_d(const double aMax) throw() {
-			return next_d(0.0, DBL_MAX);
+			return next_d(0.0, aMax);
 		}
 
 		inline double next_d() throw() {
 			return next_d(DBL_MIN, DBL_MAX);
 		}
 
+		//! \brief Fill aOutput with values in [aMin, aMax)
+		void fill(double* const aOutput, const uint32_t aCount, const double aMin = 0.0, const double aMax = 1.0) throw() {
+			SOLAIRE_INSTRUMENT(INSTRUMENT_RANDOM, aCount);
+			random_normal_all(aOutput, aCount);
+			if(aMin != 0.0 || aMax != 1.0) {
+				const double range = aMax - aMin;
+				for(uint32_t i = 0; i < aCount; ++i) aOutput[i] = range * aOutput[i] + aMin;
+			}
+		}
+
 		#define SOLAIRE_GENERATE_RANDOM(T, POSTFIX, MIN, MAX)\
 			inline T next_ ## POSTFIX(const T aMin, const T aMax) throw() {\
 				return static_cast<T>(next_d(static_cast<double>(aMin), static_cast<double>(aMax)));\
@@ -93,15 +110,15 @@ namespace solaire {
 
 	#define SOLAIRE_GENERATE_RANDOM(T, POSTFIX)\
 		template<>\
-		static T generate_random<T>() {\
+		inline T generate_random<T>() {\
 			return get_randomiser().next_ ## POSTFIX();\
 		}\
 		template<>\
-		static T generate_random<T>(const T aMax) {\
+		inline T generate_random<T>(const T aMax) {\
 			return get_randomiser().next_ ## POSTFIX(aMax);\
 		}\
 		template<>\
-		static T generate_random<T>(const T aMin, const T aMax) {\
+		inline T generate_random<T>(const T aMin, const T aMax) {\
 			return get_randomiser().next_ ## POSTFIX(aMin, aMax);\
 		}
 
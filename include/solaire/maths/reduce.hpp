@@ -0,0 +1,209 @@
+#ifndef SOLAIRE_REDUCE_HPP
+#define SOLAIRE_REDUCE_HPP
+
+//Copyright 2016 Adam G. Smith
+//
+//Licensed under the Apache License, Version 2.0 (the "License");
+//you may not use this file except in compliance with the License.
+//You may obtain a copy of the License at
+//
+//http ://www.apache.org/licenses/LICENSE-2.0
+//
+//Unless required by applicable law or agreed to in writing, software
+//distributed under the License is distributed on an "AS IS" BASIS,
+//WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//See the License for the specific language governing permissions and
+//limitations under the License.
+
+#include <cmath>
+#include "solaire/maths/vector.hpp"
+#include "solaire/maths/parallel.hpp"
+#include "solaire/maths/arena.hpp"
+#include "solaire/maths/instrument.hpp"
+
+namespace solaire {
+
+	enum summation : uint32_t {
+		SUMMATION_PAIRWISE,		//!< Independent accumulators combined as a binary tree, error grows with log(n)
+		SUMMATION_COMPENSATED	//!< Kahan summation per accumulator, error independent of n. Breaks under -ffast-math
+	};
+
+	enum {
+		REDUCE_LANES = 8,
+		REDUCE_LEAF = 128,
+		REDUCE_PARALLEL_BLOCK = 1 << 16
+	};
+
+	template<class T>
+	inline T _product_error(const T aFirst, const T aSecond, const T aProduct) throw() {
+		return static_cast<T>(0);
+	}
+
+	inline float _product_error(const float aFirst, const float aSecond, const float aProduct) throw() {
+		return std::fma(aFirst, aSecond, -aProduct);
+	}
+
+	inline double _product_error(const double aFirst, const double aSecond, const double aProduct) throw() {
+		return std::fma(aFirst, aSecond, -aProduct);
+	}
+
+	template<class T>
+	inline T _combine_lanes(const T* const aLanes) throw() {
+		return ((aLanes[0] + aLanes[1]) + (aLanes[2] + aLanes[3])) + ((aLanes[4] + aLanes[5]) + (aLanes[6] + aLanes[7]));
+	}
+
+	template<class T>
+	T _pairwise_sum(const T* const aData, const uint32_t aCount) throw() {
+		if(aCount > REDUCE_LEAF) {
+			const uint32_t half = (aCount / 2) & ~static_cast<uint32_t>(REDUCE_LANES - 1);
+			return _pairwise_sum(aData, half) + _pairwise_sum(aData + half, aCount - half);
+		}
+
+		T lanes[REDUCE_LANES];
+		for(uint32_t j = 0; j < REDUCE_LANES; ++j) lanes[j] = static_cast<T>(0);
+		uint32_t i = 0;
+		for(; i + REDUCE_LANES <= aCount; i += REDUCE_LANES) {
+			for(uint32_t j = 0; j < REDUCE_LANES; ++j) lanes[j] += aData[i + j];
+		}
+		for(uint32_t j = 0; i < aCount; ++i, ++j) lanes[j] += aData[i];
+		return _combine_lanes(lanes);
+	}
+
+	template<class T>
+	T _pairwise_dot(const T* const aFirst, const T* const aSecond, const uint32_t aCount) throw() {
+		if(aCount > REDUCE_LEAF) {
+			const uint32_t half = (aCount / 2) & ~static_cast<uint32_t>(REDUCE_LANES - 1);
+			return _pairwise_dot(aFirst, aSecond, half) + _pairwise_dot(aFirst + half, aSecond + half, aCount - half);
+		}
+
+		T lanes[REDUCE_LANES];
+		for(uint32_t j = 0; j < REDUCE_LANES; ++j) lanes[j] = static_cast<T>(0);
+		uint32_t i = 0;
+		for(; i + REDUCE_LANES <= aCount; i += REDUCE_LANES) {
+			for(uint32_t j = 0; j < REDUCE_LANES; ++j) lanes[j] += aFirst[i + j] * aSecond[i + j];
+		}
+		for(uint32_t j = 0; i < aCount; ++i, ++j) lanes[j] += aFirst[i] * aSecond[i];
+		return _combine_lanes(lanes);
+	}
+
+	template<class T>
+	T _compensated_dot(const T* const aFirst, const T* const aSecond, const uint32_t aCount) throw() {
+		T sums[REDUCE_LANES];
+		T errors[REDUCE_LANES];
+		for(uint32_t j = 0; j < REDUCE_LANES; ++j) {
+			sums[j] = static_cast<T>(0);
+			errors[j] = static_cast<T>(0);
+		}
+
+		// Kahan summation of the rounded products, the rounding error of each product is accumulated separately
+		for(uint32_t i = 0; i < aCount; i += REDUCE_LANES) {
+			const uint32_t count = aCount - i < REDUCE_LANES ? aCount - i : static_cast<uint32_t>(REDUCE_LANES);
+			for(uint32_t j = 0; j < count; ++j) {
+				const T product = aFirst[i + j] * aSecond[i + j];
+				const T y = product - errors[j];
+				const T t = sums[j] + y;
+				errors[j] = ((t - sums[j]) - y) - _product_error(aFirst[i + j], aSecond[i + j], product);
+				sums[j] = t;
+			}
+		}
+
+		T sum = static_cast<T>(0);
+		T error = static_cast<T>(0);
+		for(uint32_t j = 0; j < REDUCE_LANES; ++j) {
+			const T y = sums[j] - errors[j] - error;
+			const T t = sum + y;
+			error = (t - sum) - y;
+			sum = t;
+		}
+		return sum;
+	}
+
+	template<class T>
+	T _compensated_sum(const T* const aData, const uint32_t aCount) throw() {
+		T sums[REDUCE_LANES];
+		T errors[REDUCE_LANES];
+		for(uint32_t j = 0; j < REDUCE_LANES; ++j) {
+			sums[j] = static_cast<T>(0);
+			errors[j] = static_cast<T>(0);
+		}
+
+		for(uint32_t i = 0; i < aCount; i += REDUCE_LANES) {
+			const uint32_t count = aCount - i < REDUCE_LANES ? aCount - i : static_cast<uint32_t>(REDUCE_LANES);
+			for(uint32_t j = 0; j < count; ++j) {
+				const T y = aData[i + j] - errors[j];
+				const T t = sums[j] + y;
+				errors[j] = (t - sums[j]) - y;
+				sums[j] = t;
+			}
+		}
+
+		T sum = static_cast<T>(0);
+		T error = static_cast<T>(0);
+		for(uint32_t j = 0; j < REDUCE_LANES; ++j) {
+			const T y = sums[j] - errors[j] - error;
+			const T t = sum + y;
+			error = (t - sum) - y;
+			sum = t;
+		}
+		return sum;
+	}
+
+	template<class T>
+	T sum(const T* const aData, const uint32_t aCount, const summation aMode = SUMMATION_PAIRWISE) throw() {
+		return aMode == SUMMATION_COMPENSATED ? _compensated_sum(aData, aCount) : _pairwise_sum(aData, aCount);
+	}
+
+	template<class T>
+	T dot(const T* const aFirst, const T* const aSecond, const uint32_t aCount, const summation aMode = SUMMATION_PAIRWISE) throw() {
+		return aMode == SUMMATION_COMPENSATED ? _compensated_dot(aFirst, aSecond, aCount) : _pairwise_dot(aFirst, aSecond, aCount);
+	}
+
+	template<class T, const uint32_t S>
+	T dot(const vector<T,S>* const aFirst, const vector<T,S>* const aSecond, const uint32_t aCount, const summation aMode = SUMMATION_PAIRWISE) throw() {
+		return dot(reinterpret_cast<const T*>(aFirst), reinterpret_cast<const T*>(aSecond), aCount * S, aMode);
+	}
+
+	//! \brief Sum split into fixed size blocks across threads, the result does not depend on the thread count
+	template<class T>
+	T parallel_sum(const T* const aData, const uint32_t aCount, const summation aMode = SUMMATION_PAIRWISE) {
+		SOLAIRE_INSTRUMENT(INSTRUMENT_REDUCE, aCount);
+		const uint32_t blocks = (aCount + REDUCE_PARALLEL_BLOCK - 1) / REDUCE_PARALLEL_BLOCK;
+		if(blocks <= 1) return sum(aData, aCount, aMode);
+
+		arena_scope scope(get_thread_arena());
+		T* const partials = scope.allocate<T>(blocks);
+		parallel_for(blocks, 1, [=](const uint32_t aBegin, const uint32_t aEnd) {
+			for(uint32_t i = aBegin; i < aEnd; ++i) {
+				const uint32_t offset = i * REDUCE_PARALLEL_BLOCK;
+				const uint32_t count = aCount - offset < REDUCE_PARALLEL_BLOCK ? aCount - offset : static_cast<uint32_t>(REDUCE_PARALLEL_BLOCK);
+				partials[i] = sum(aData + offset, count, aMode);
+			}
+		});
+		return sum(partials, blocks, aMode);
+	}
+
+	template<class T>
+	T parallel_dot(const T* const aFirst, const T* const aSecond, const uint32_t aCount, const summation aMode = SUMMATION_PAIRWISE) {
+		SOLAIRE_INSTRUMENT(INSTRUMENT_REDUCE, aCount);
+		const uint32_t blocks = (aCount + REDUCE_PARALLEL_BLOCK - 1) / REDUCE_PARALLEL_BLOCK;
+		if(blocks <= 1) return dot(aFirst, aSecond, aCount, aMode);
+
+		arena_scope scope(get_thread_arena());
+		T* const partials = scope.allocate<T>(blocks);
+		parallel_for(blocks, 1, [=](const uint32_t aBegin, const uint32_t aEnd) {
+			for(uint32_t i = aBegin; i < aEnd; ++i) {
+				const uint32_t offset = i * REDUCE_PARALLEL_BLOCK;
+				const uint32_t count = aCount - offset < REDUCE_PARALLEL_BLOCK ? aCount - offset : static_cast<uint32_t>(REDUCE_PARALLEL_BLOCK);
+				partials[i] = dot(aFirst + offset, aSecond + offset, count, aMode);
+			}
+		});
+		return sum(partials, blocks, aMode);
+	}
+
+	template<class T, const uint32_t S>
+	T parallel_dot(const vector<T,S>* const aFirst, const vector<T,S>* const aSecond, const uint32_t aCount, const summation aMode = SUMMATION_PAIRWISE) {
+		return parallel_dot(reinterpret_cast<const T*>(aFirst), reinterpret_cast<const T*>(aSecond), aCount * S, aMode);
+	}
+}
+
+#endif
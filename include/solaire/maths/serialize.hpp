@@ -0,0 +1,318 @@
+#ifndef SOLAIRE_SERIALIZE_HPP
+#define SOLAIRE_SERIALIZE_HPP
+
+//Copyright 2016 Adam G. Smith
+//
+//Licensed under the Apache License, Version 2.0 (the "License");
+//you may not use this file except in compliance with the License.
+//You may obtain a copy of the License at
+//
+//http ://www.apache.org/licenses/LICENSE-2.0
+//
+//Unless required by applicable law or agreed to in writing, software
+//distributed under the License is distributed on an "AS IS" BASIS,
+//WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//See the License for the specific language governing permissions and
+//limitations under the License.
+
+#include <cstdio>
+#include <cstring>
+#include "solaire/maths/matrix.hpp"
+
+extern "C" SOLAIRE_EXPORT_API const void* SOLAIRE_EXPORT_CALL solaire_map_file(const char*, uint64_t*);
+extern "C" SOLAIRE_EXPORT_API void SOLAIRE_EXPORT_CALL solaire_unmap_file(const void*, const uint64_t);
+
+namespace solaire {
+
+	enum scalar_type : uint16_t {
+		SCALAR_UNKNOWN,
+		SCALAR_INT8,
+		SCALAR_UINT8,
+		SCALAR_INT16,
+		SCALAR_UINT16,
+		SCALAR_INT32,
+		SCALAR_UINT32,
+		SCALAR_INT64,
+		SCALAR_UINT64,
+		SCALAR_HALF,
+		SCALAR_FLOAT32,
+		SCALAR_FLOAT64
+	};
+
+	template<class T>
+	struct scalar_type_of {
+		enum{value = SCALAR_UNKNOWN};
+	};
+
+	#define SOLAIRE_SCALAR_TYPE(aType, aValue)\
+		template<>\
+		struct scalar_type_of<aType> {\
+			enum{value = aValue};\
+		};
+
+	SOLAIRE_SCALAR_TYPE(int8_t, SCALAR_INT8)
+	SOLAIRE_SCALAR_TYPE(uint8_t, SCALAR_UINT8)
+	SOLAIRE_SCALAR_TYPE(int16_t, SCALAR_INT16)
+	SOLAIRE_SCALAR_TYPE(uint16_t, SCALAR_UINT16)
+	SOLAIRE_SCALAR_TYPE(int32_t, SCALAR_INT32)
+	SOLAIRE_SCALAR_TYPE(uint32_t, SCALAR_UINT32)
+	SOLAIRE_SCALAR_TYPE(int64_t, SCALAR_INT64)
+	SOLAIRE_SCALAR_TYPE(uint64_t, SCALAR_UINT64)
+	SOLAIRE_SCALAR_TYPE(half, SCALAR_HALF)
+	SOLAIRE_SCALAR_TYPE(float, SCALAR_FLOAT32)
+	SOLAIRE_SCALAR_TYPE(double, SCALAR_FLOAT64)
+
+	#undef SOLAIRE_SCALAR_TYPE
+
+	//! \brief Describes how an array element is laid out as a W x H grid of scalars
+	template<class E>
+	struct array_element {
+		typedef E scalar_t;
+		enum {
+			WIDTH = 1,
+			HEIGHT = 1
+		};
+	};
+
+	template<class T, const uint32_t S>
+	struct array_element<vector<T,S>> {
+		typedef T scalar_t;
+		enum {
+			WIDTH = S,
+			HEIGHT = 1
+		};
+	};
+
+	template<class T, const uint32_t W, const uint32_t H>
+	struct array_element<matrix<T,W,H>> {
+		typedef T scalar_t;
+		enum {
+			WIDTH = W,
+			HEIGHT = H
+		};
+	};
+
+	enum {
+		ARRAY_VERSION = 1,
+		ARRAY_ENDIAN_MARKER = 0x0102,
+		ARRAY_ALIGNMENT = 64,
+		ARRAY_WRITE_BUFFER = 1 << 20
+	};
+
+	//! \brief 64 byte header preceding the raw element data, stored in the writer's byte order
+	struct array_header {
+		char magic[4];			//!< "SLMA"
+		uint16_t version;
+		uint16_t endian;		//!< ARRAY_ENDIAN_MARKER as written by the producer
+		uint16_t scalar;		//!< scalar_type
+		uint16_t scalar_size;
+		uint32_t width;
+		uint32_t height;
+		uint32_t alignment;		//!< Of the data offset
+		uint64_t count;
+		uint64_t data_offset;
+		uint8_t reserved[24];
+	};
+
+	static_assert(sizeof(array_header) == ARRAY_ALIGNMENT, "solaire::array_header : Must be 64 bytes");
+
+	template<class E>
+	array_header make_array_header(const uint64_t aCount) throw() {
+		typedef typename array_element<E>::scalar_t scalar_t;
+		static_assert(static_cast<uint32_t>(scalar_type_of<scalar_t>::value) != static_cast<uint32_t>(SCALAR_UNKNOWN), "solaire::make_array_header : Unsupported scalar type");
+		static_assert(sizeof(E) == sizeof(scalar_t) * array_element<E>::WIDTH * array_element<E>::HEIGHT, "solaire::make_array_header : Element must be tightly packed");
+
+		array_header tmp;
+		std::memset(&tmp, 0, sizeof(array_header));
+		std::memcpy(tmp.magic, "SLMA", 4);
+		tmp.version = ARRAY_VERSION;
+		tmp.endian = ARRAY_ENDIAN_MARKER;
+		tmp.scalar = scalar_type_of<scalar_t>::value;
+		tmp.scalar_size = sizeof(scalar_t);
+		tmp.width = array_element<E>::WIDTH;
+		tmp.height = array_element<E>::HEIGHT;
+		tmp.alignment = ARRAY_ALIGNMENT;
+		tmp.count = aCount;
+		tmp.data_offset = ARRAY_ALIGNMENT;
+		return tmp;
+	}
+
+	//! \brief Check that a header was written natively for arrays of E
+	template<class E>
+	bool is_compatible(const array_header& aHeader) throw() {
+		const array_header expected = make_array_header<E>(0);
+		return
+			std::memcmp(aHeader.magic, expected.magic, 4) == 0 &&
+			aHeader.version == expected.version &&
+			aHeader.endian == expected.endian &&
+			aHeader.scalar == expected.scalar &&
+			aHeader.scalar_size == expected.scalar_size &&
+			aHeader.width == expected.width &&
+			aHeader.height == expected.height &&
+			aHeader.data_offset % alignof(E) == 0;
+	}
+
+	//! \brief Streams arrays of E to a file in chunks, the element count is patched into the header on close
+	template<class E>
+	class array_writer {
+	private:
+		FILE* mFile;
+		uint64_t mCount;
+	private:
+		array_writer(const array_writer<E>&) = delete;
+		array_writer<E>& operator=(const array_writer<E>&) = delete;
+	public:
+		array_writer() :
+			mFile(nullptr),
+			mCount(0)
+		{}
+
+		~array_writer() {
+			close();
+		}
+
+		bool open(const char* const aPath) {
+			close();
+			mFile = std::fopen(aPath, "wb");
+			if(! mFile) return false;
+			std::setvbuf(mFile, nullptr, _IOFBF, ARRAY_WRITE_BUFFER);
+			mCount = 0;
+			const array_header header = make_array_header<E>(0);
+			if(std::fwrite(&header, sizeof(array_header), 1, mFile) != 1) {
+				std::fclose(mFile);
+				mFile = nullptr;
+				return false;
+			}
+			return true;
+		}
+
+		inline bool is_open() const throw() {
+			return mFile != nullptr;
+		}
+
+		inline uint64_t size() const throw() {
+			return mCount;
+		}
+
+		bool write(const E* const aData, const uint32_t aCount) {
+			if(! mFile) return false;
+			const size_t written = std::fwrite(aData, sizeof(E), aCount, mFile);
+			mCount += written;
+			return written == aCount;
+		}
+
+		inline bool write(const E& aValue) {
+			return write(&aValue, 1);
+		}
+
+		bool close() {
+			if(! mFile) return true;
+			const array_header header = make_array_header<E>(mCount);
+			bool success = std::fflush(mFile) == 0;
+			success = success && std::fseek(mFile, 0, SEEK_SET) == 0;
+			success = success && std::fwrite(&header, sizeof(array_header), 1, mFile) == 1;
+			success = std::fclose(mFile) == 0 && success;
+			mFile = nullptr;
+			return success;
+		}
+	};
+
+	template<class E>
+	bool write_array(const char* const aPath, const E* const aData, const uint32_t aCount) {
+		array_writer<E> writer;
+		return writer.open(aPath) && writer.write(aData, aCount) && writer.close();
+	}
+
+	//! \brief Read only memory mapped view of a file written by array_writer, elements are used in place without copying
+	//! \detail Files written with a different byte order or element layout are rejected
+	template<class E>
+	class mapped_array {
+	private:
+		const void* mMapping;
+		uint64_t mMappedSize;
+		const E* mData;
+		uint64_t mCount;
+	private:
+		mapped_array(const mapped_array<E>&) = delete;
+		mapped_array<E>& operator=(const mapped_array<E>&) = delete;
+	public:
+		mapped_array() :
+			mMapping(nullptr),
+			mMappedSize(0),
+			mData(nullptr),
+			mCount(0)
+		{}
+
+		mapped_array(mapped_array<E>&& aOther) :
+			mMapping(aOther.mMapping),
+			mMappedSize(aOther.mMappedSize),
+			mData(aOther.mData),
+			mCount(aOther.mCount)
+		{
+			aOther.mMapping = nullptr;
+			aOther.close();
+		}
+
+		~mapped_array() {
+			close();
+		}
+
+		bool open(const char* const aPath) {
+			close();
+			uint64_t size = 0;
+			const void* const mapping = solaire_map_file(aPath, &size);
+			if(! mapping) return false;
+
+			array_header header;
+			if(size < sizeof(array_header)) {
+				solaire_unmap_file(mapping, size);
+				return false;
+			}
+			std::memcpy(&header, mapping, sizeof(array_header));
+			if(! (is_compatible<E>(header) && header.data_offset <= size && header.count <= (size - header.data_offset) / sizeof(E))) {
+				solaire_unmap_file(mapping, size);
+				return false;
+			}
+
+			mMapping = mapping;
+			mMappedSize = size;
+			mData = reinterpret_cast<const E*>(static_cast<const uint8_t*>(mapping) + header.data_offset);
+			mCount = header.count;
+			return true;
+		}
+
+		void close() throw() {
+			if(mMapping) solaire_unmap_file(mMapping, mMappedSize);
+			mMapping = nullptr;
+			mMappedSize = 0;
+			mData = nullptr;
+			mCount = 0;
+		}
+
+		inline bool is_open() const throw() {
+			return mMapping != nullptr;
+		}
+
+		inline const E* data() const throw() {
+			return mData;
+		}
+
+		inline uint64_t size() const throw() {
+			return mCount;
+		}
+
+		inline const E& operator[](const uint64_t aIndex) const throw() {
+			return mData[aIndex];
+		}
+
+		inline const E* begin() const throw() {
+			return mData;
+		}
+
+		inline const E* end() const throw() {
+			return mData + mCount;
+		}
+	};
+}
+
+#endif
@@ -0,0 +1,270 @@
+#ifndef SOLAIRE_SHUFFLE_HPP
+#define SOLAIRE_SHUFFLE_HPP
+
+//Copyright 2016 Adam G. Smith
+//
+//Licensed under the Apache License, Version 2.0 (the "License");
+//you may not use this file except in compliance with the License.
+//You may obtain a copy of the License at
+//
+//http ://www.apache.org/licenses/LICENSE-2.0
+//
+//Unless required by applicable law or agreed to in writing, software
+//distributed under the License is distributed on an "AS IS" BASIS,
+//WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//See the License for the specific language governing permissions and
+//limitations under the License.
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+#include "solaire/maths/xorshift.hpp"
+#include "solaire/maths/hash.hpp"
+#include "solaire/maths/arena.hpp"
+#include "solaire/maths/parallel.hpp"
+#include "solaire/maths/instrument.hpp"
+
+namespace solaire {
+
+	enum : uint32_t {
+		SHUFFLE_BLOCK = 1 << 16,	//!< Elements shuffled serially before parallel_shuffle starts merging, fixed so results do not depend on the thread count
+		SAMPLE_DENSE = 8			//!< sample_without_replacement scans the population when it is less than this many times the sample count
+	};
+
+	//! \brief Uniform Fisher-Yates shuffle
+	template<class T>
+	void shuffle(T* const aData, const uint32_t aCount, xorshift_engine& aEngine) {
+		SOLAIRE_INSTRUMENT(INSTRUMENT_RANDOM, aCount);
+		for(uint32_t i = aCount; i > 1; --i) std::swap(aData[i - 1], aData[aEngine.next(i)]);
+	}
+
+	template<class T>
+	inline void shuffle(T* const aData, const uint32_t aCount, const uint64_t aSeed) {
+		xorshift_engine engine(aSeed);
+		shuffle(aData, aCount, engine);
+	}
+
+	//! \brief Merge two adjacent uniformly shuffled runs into one, [aBegin, aMiddle) and [aMiddle, aEnd)
+	//! \detail Interleaves by coin flip until one run is exhausted then inserts the rest with Fisher-Yates steps (Bacher et al. MergeShuffle)
+	template<class T>
+	void _merge_shuffle(T* const aData, const uint32_t aBegin, const uint32_t aMiddle, const uint32_t aEnd, xorshift_engine& aEngine) {
+		uint32_t i = aBegin;
+		uint32_t j = aMiddle;
+		uint64_t bits = 0;
+		uint32_t remaining = 0;
+
+		// Neither run can be exhausted here, so the coin flip picks the swap index arithmetically instead of branching
+		while(i < j && j < aEnd) {
+			if(remaining == 0) {
+				bits = aEngine.next();
+				remaining = 64;
+			}
+			const uint32_t flip = static_cast<uint32_t>(bits & 1);
+			bits >>= 1;
+			--remaining;
+			std::swap(aData[i], aData[i + ((j - i) & (0u - flip))]);
+			j += flip;
+			++i;
+		}
+
+		while(true) {
+			if(remaining == 0) {
+				bits = aEngine.next();
+				remaining = 64;
+			}
+			const bool flip = (bits & 1) != 0;
+			bits >>= 1;
+			--remaining;
+			if(flip) {
+				if(j == aEnd) break;
+				std::swap(aData[i], aData[j]);
+				++j;
+			}else if(i == j) {
+				break;
+			}
+			++i;
+		}
+		for(; i < aEnd; ++i) std::swap(aData[i], aData[aBegin + aEngine.next(i - aBegin + 1)]);
+	}
+
+	inline uint64_t _shuffle_seed(const uint64_t aSeed, const uint32_t aLevel, const uint32_t aIndex) throw() {
+		return hash_mix(aSeed ^ ((static_cast<uint64_t>(aLevel) << 32) | aIndex));
+	}
+
+	//! \brief Uniform shuffle of large arrays across threads
+	//! \detail Blocks of SHUFFLE_BLOCK elements are shuffled independently then merged pairwise, level by level.
+	//! Each block and merge draws from its own engine seeded by aSeed and its position in the tree,
+	//! so the result for a given seed is the same for any thread count.
+	template<class T>
+	void parallel_shuffle(T* const aData, const uint32_t aCount, const uint64_t aSeed) {
+		SOLAIRE_INSTRUMENT(INSTRUMENT_RANDOM, aCount);
+		const uint32_t blocks = (aCount + SHUFFLE_BLOCK - 1) / SHUFFLE_BLOCK;
+
+		parallel_for(blocks, 1, [=](const uint32_t aBegin, const uint32_t aEnd) {
+			for(uint32_t i = aBegin; i < aEnd; ++i) {
+				const uint32_t begin = i * SHUFFLE_BLOCK;
+				const uint32_t count = aCount - begin < SHUFFLE_BLOCK ? aCount - begin : static_cast<uint32_t>(SHUFFLE_BLOCK);
+				xorshift_engine engine(_shuffle_seed(aSeed, 0, i));
+				for(uint32_t j = count; j > 1; --j) std::swap(aData[begin + j - 1], aData[begin + engine.next(j)]);
+			}
+		});
+
+		uint32_t level = 1;
+		for(uint64_t width = SHUFFLE_BLOCK; width < aCount; width *= 2, ++level) {
+			const uint32_t merges = static_cast<uint32_t>((aCount + width * 2 - 1) / (width * 2));
+			parallel_for(merges, 1, [=](const uint32_t aBegin, const uint32_t aEnd) {
+				for(uint32_t i = aBegin; i < aEnd; ++i) {
+					const uint64_t begin = i * width * 2;
+					const uint64_t middle = begin + width;
+					if(middle >= aCount) continue;
+					const uint64_t end = middle + width < aCount ? middle + width : aCount;
+					xorshift_engine engine(_shuffle_seed(aSeed, level, i));
+					_merge_shuffle(aData, static_cast<uint32_t>(begin), static_cast<uint32_t>(middle), static_cast<uint32_t>(end), engine);
+				}
+			});
+		}
+	}
+
+	//! \brief Choose aSamples elements uniformly from aInput, Li's algorithm L
+	//! \detail Skips directly between replaced elements so only O(aSamples * log(aCount / aSamples)) values are drawn
+	//! \return The number of elements written to aOutput, min(aCount, aSamples)
+	template<class T>
+	uint32_t reservoir_sample(const T* const aInput, const uint32_t aCount, T* const aOutput, const uint32_t aSamples, xorshift_engine& aEngine) {
+		SOLAIRE_INSTRUMENT(INSTRUMENT_RANDOM, aSamples);
+		if(aSamples >= aCount) {
+			std::copy(aInput, aInput + aCount, aOutput);
+			return aCount;
+		}
+		if(aSamples == 0) return 0;
+		std::copy(aInput, aInput + aSamples, aOutput);
+
+		const double k = static_cast<double>(aSamples);
+		double w = std::exp(std::log(aEngine.next_open_normal()) / k);
+		uint64_t i = aSamples - 1;
+		while(true) {
+			i += static_cast<uint64_t>(std::floor(std::log(aEngine.next_open_normal()) / std::log1p(-w))) + 1;
+			if(i >= aCount) break;
+			aOutput[aEngine.next(aSamples)] = aInput[i];
+			w *= std::exp(std::log(aEngine.next_open_normal()) / k);
+		}
+		return aSamples;
+	}
+
+	template<class T>
+	inline uint32_t reservoir_sample(const T* const aInput, const uint32_t aCount, T* const aOutput, const uint32_t aSamples, const uint64_t aSeed) {
+		xorshift_engine engine(aSeed);
+		return reservoir_sample(aInput, aCount, aOutput, aSamples, engine);
+	}
+
+	//! \brief Uniform sample of a stream whose length is not known in advance, algorithm L
+	template<class T>
+	class reservoir_sampler {
+	private:
+		std::vector<T> mSamples;
+		xorshift_engine mEngine;
+		uint64_t mSeen;
+		uint64_t mNext;
+		double mW;
+		uint32_t mCapacity;
+	private:
+		void _skip() throw() {
+			mNext += static_cast<uint64_t>(std::floor(std::log(mEngine.next_open_normal()) / std::log1p(-mW))) + 1;
+		}
+	public:
+		reservoir_sampler(const uint32_t aCapacity, const uint64_t aSeed) :
+			mEngine(aSeed),
+			mSeen(0),
+			mNext(0),
+			mW(0.0),
+			mCapacity(aCapacity)
+		{
+			mSamples.reserve(aCapacity);
+		}
+
+		void add(const T& aValue) {
+			if(mCapacity == 0) {
+				++mSeen;
+				return;
+			}
+			if(mSeen < mCapacity) {
+				mSamples.push_back(aValue);
+				if(++mSeen == mCapacity) {
+					mW = std::exp(std::log(mEngine.next_open_normal()) / mCapacity);
+					mNext = mSeen - 1;
+					_skip();
+				}
+				return;
+			}
+			if(mSeen++ == mNext) {
+				mSamples[mEngine.next(mCapacity)] = aValue;
+				mW *= std::exp(std::log(mEngine.next_open_normal()) / mCapacity);
+				_skip();
+			}
+		}
+
+		inline const std::vector<T>& get_samples() const throw() {
+			return mSamples;
+		}
+
+		inline uint64_t get_seen() const throw() {
+			return mSeen;
+		}
+
+		inline uint32_t get_capacity() const throw() {
+			return mCapacity;
+		}
+	};
+
+	//! \brief Choose aSamples distinct indices from [0, aPopulation) uniformly, written to aOutput in ascending order
+	//! \detail Dense samples scan the population with Knuth's selection sampling,
+	//! sparse samples use Floyd's algorithm with a hash set taken from the thread arena.
+	//! \return The number of indices written, min(aPopulation, aSamples)
+	inline uint32_t sample_without_replacement(const uint32_t aPopulation, uint32_t* const aOutput, const uint32_t aSamples, xorshift_engine& aEngine) {
+		SOLAIRE_INSTRUMENT(INSTRUMENT_RANDOM, aSamples);
+		const uint32_t samples = aSamples < aPopulation ? aSamples : aPopulation;
+		if(samples == 0) return 0;
+
+		if(static_cast<uint64_t>(samples) * SAMPLE_DENSE >= aPopulation) {
+			uint32_t needed = samples;
+			for(uint32_t i = 0, o = 0; needed > 0; ++i) {
+				if(aEngine.next(aPopulation - i) < needed) {
+					aOutput[o++] = i;
+					--needed;
+				}
+			}
+			return samples;
+		}
+
+		enum : uint32_t { EMPTY = 0xFFFFFFFF };
+		uint32_t size = 16;
+		while(size < samples * 2) size *= 2;
+		const uint32_t mask = size - 1;
+		arena_scope scope(get_thread_arena());
+		uint32_t* const table = scope.allocate<uint32_t>(size);
+		std::fill(table, table + size, static_cast<uint32_t>(EMPTY));
+
+		uint32_t o = 0;
+		for(uint32_t j = aPopulation - samples; j < aPopulation; ++j) {
+			uint32_t value = aEngine.next(j + 1);
+			uint32_t slot = hash_mix(value) & mask;
+			while(table[slot] != EMPTY && table[slot] != value) slot = (slot + 1) & mask;
+			if(table[slot] == value) {
+				// Already chosen, j cannot have been chosen before this step
+				value = j;
+				slot = hash_mix(value) & mask;
+				while(table[slot] != EMPTY) slot = (slot + 1) & mask;
+			}
+			table[slot] = value;
+			aOutput[o++] = value;
+		}
+		std::sort(aOutput, aOutput + samples);
+		return samples;
+	}
+
+	inline uint32_t sample_without_replacement(const uint32_t aPopulation, uint32_t* const aOutput, const uint32_t aSamples, const uint64_t aSeed) {
+		xorshift_engine engine(aSeed);
+		return sample_without_replacement(aPopulation, aOutput, aSamples, engine);
+	}
+}
+
+#endif
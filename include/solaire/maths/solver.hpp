@@ -0,0 +1,438 @@
+#ifndef SOLAIRE_SOLVER_HPP
+#define SOLAIRE_SOLVER_HPP
+
+//Copyright 2016 Adam G. Smith
+//
+//Licensed under the Apache License, Version 2.0 (the "License");
+//you may not use this file except in compliance with the License.
+//You may obtain a copy of the License at
+//
+//http ://www.apache.org/licenses/LICENSE-2.0
+//
+//Unless required by applicable law or agreed to in writing, software
+//distributed under the License is distributed on an "AS IS" BASIS,
+//WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//See the License for the specific language governing permissions and
+//limitations under the License.
+
+#include <cmath>
+#include <vector>
+#include "solaire/maths/sparse_matrix.hpp"
+#include "solaire/maths/reduce.hpp"
+
+namespace solaire {
+
+	// Operator adapters, anything with rows() and multiply(const T*, T*) can be solved
+	// Operators that also accept multiply(const T*, T*, execution) follow the workspace's serial / parallel choice
+
+	template<class M>
+	inline uint32_t _operator_size(const M& aOperator) throw() {
+		return aOperator.rows();
+	}
+
+	template<class M, class T>
+	inline auto _operator_multiply(const M& aOperator, const T* const aVector, T* const aOutput, const execution aExecution, int) -> decltype(aOperator.multiply(aVector, aOutput, aExecution), void()) {
+		aOperator.multiply(aVector, aOutput, aExecution);
+	}
+
+	template<class M, class T>
+	inline void _operator_multiply(const M& aOperator, const T* const aVector, T* const aOutput, const execution, long) {
+		aOperator.multiply(aVector, aOutput);
+	}
+
+	template<class M, class T>
+	inline void _operator_multiply(const M& aOperator, const T* const aVector, T* const aOutput, const execution aExecution) {
+		_operator_multiply(aOperator, aVector, aOutput, aExecution, 0);
+	}
+
+	template<class T, const uint32_t N>
+	inline uint32_t _operator_size(const matrix<T,N,N>& aOperator) throw() {
+		return N;
+	}
+
+	template<class T, const uint32_t N>
+	inline void _operator_multiply(const matrix<T,N,N>& aOperator, const T* const aVector, T* const aOutput, const execution) throw() {
+		for(uint32_t i = 0; i < N; ++i) aOutput[i] = dot(aOperator[i], aVector, N);
+	}
+
+	template<class T>
+	struct solver_result {
+		uint32_t iterations;
+		T residual;		//!< Final |b - Ax| / |b|
+		bool converged;
+	};
+
+	//! \brief Scratch vectors reused across solves, a solve only allocates when the system grows
+	//! \detail With aParallel set the vector updates, dot products and sparse multiplies are split across threads
+	template<class T>
+	class solver_workspace {
+	public:
+		enum {
+			BUFFERS = 8,
+			BLOCK = 1 << 14
+		};
+	private:
+		std::vector<T> mBuffers[BUFFERS];
+		std::vector<T> mPartials;
+		uint32_t mSize;
+		bool mParallel;
+	public:
+		solver_workspace(const bool aParallel = false) :
+			mSize(0),
+			mParallel(aParallel)
+		{}
+
+		void reserve(const uint32_t aSize) {
+			mSize = aSize;
+			for(uint32_t i = 0; i < BUFFERS; ++i) if(mBuffers[i].size() < aSize) mBuffers[i].resize(aSize);
+			const uint32_t blocks = (aSize + BLOCK - 1) / BLOCK;
+			if(mPartials.size() < blocks) mPartials.resize(blocks);
+		}
+
+		inline T* operator[](const uint32_t aIndex) throw() {
+			return mBuffers[aIndex].data();
+		}
+
+		inline bool is_parallel() const throw() {
+			return mParallel;
+		}
+
+		inline void set_parallel(const bool aParallel) throw() {
+			mParallel = aParallel;
+		}
+
+		inline execution get_execution() const throw() {
+			return mParallel ? EXECUTION_PARALLEL : EXECUTION_SERIAL;
+		}
+
+		//! \brief Deterministic blocked dot product, the result does not depend on the thread count
+		T dot(const T* const aFirst, const T* const aSecond) {
+			const uint32_t size = mSize;
+			const uint32_t blocks = (size + BLOCK - 1) / BLOCK;
+			T* const partials = mPartials.data();
+			const auto kernel = [=](const uint32_t aBegin, const uint32_t aEnd) {
+				for(uint32_t i = aBegin; i < aEnd; ++i) {
+					const uint32_t offset = i * BLOCK;
+					partials[i] = solaire::dot(aFirst + offset, aSecond + offset, size - offset < BLOCK ? size - offset : static_cast<uint32_t>(BLOCK));
+				}
+			};
+			parallel_for(get_execution(), blocks, 1, kernel);
+			return sum(partials, blocks);
+		}
+
+		inline T norm(const T* const aVector) {
+			return static_cast<T>(std::sqrt(dot(aVector, aVector)));
+		}
+
+		//! \brief aOutput = aFirst * aScale + aSecond * aOtherScale
+		void combine(const T* const aFirst, const T aScale, const T* const aSecond, const T aOtherScale, T* const aOutput) {
+			const auto kernel = [=](const uint32_t aBegin, const uint32_t aEnd) {
+				for(uint32_t i = aBegin; i < aEnd; ++i) aOutput[i] = aFirst[i] * aScale + aSecond[i] * aOtherScale;
+			};
+			parallel_for(get_execution(), mSize, BLOCK, kernel);
+		}
+
+		//! \brief aOutput += aVector * aScale
+		void axpy(const T aScale, const T* const aVector, T* const aOutput) {
+			const auto kernel = [=](const uint32_t aBegin, const uint32_t aEnd) {
+				for(uint32_t i = aBegin; i < aEnd; ++i) aOutput[i] += aVector[i] * aScale;
+			};
+			parallel_for(get_execution(), mSize, BLOCK, kernel);
+		}
+
+		inline void copy(const T* const aInput, T* const aOutput) throw() {
+			for(uint32_t i = 0; i < mSize; ++i) aOutput[i] = aInput[i];
+		}
+	};
+
+	template<class T>
+	class identity_preconditioner {
+	public:
+		inline void apply(const T* const aInput, T* const aOutput, const uint32_t aSize) const throw() {
+			for(uint32_t i = 0; i < aSize; ++i) aOutput[i] = aInput[i];
+		}
+	};
+
+	template<class T>
+	class jacobi_preconditioner {
+	private:
+		std::vector<T> mInverseDiagonal;
+	public:
+		explicit jacobi_preconditioner(const csr_matrix<T>& aMatrix) :
+			mInverseDiagonal(aMatrix.rows())
+		{
+			aMatrix.diagonal(mInverseDiagonal.data());
+			for(T& i : mInverseDiagonal) i = i == static_cast<T>(0) ? static_cast<T>(1) : static_cast<T>(1) / i;
+		}
+
+		template<const uint32_t N>
+		explicit jacobi_preconditioner(const matrix<T,N,N>& aMatrix) :
+			mInverseDiagonal(N)
+		{
+			for(uint32_t i = 0; i < N; ++i) mInverseDiagonal[i] = aMatrix[i][i] == static_cast<T>(0) ? static_cast<T>(1) : static_cast<T>(1) / aMatrix[i][i];
+		}
+
+		inline void apply(const T* const aInput, T* const aOutput, const uint32_t aSize) const throw() {
+			const T* const diagonal = mInverseDiagonal.data();
+			for(uint32_t i = 0; i < aSize; ++i) aOutput[i] = aInput[i] * diagonal[i];
+		}
+	};
+
+	//! \brief Zero fill incomplete Cholesky factorisation A ~ L * L^T for symmetric positive definite matrices
+	//! \detail Only the lower triangle of the input is read. Non-positive pivots fall back to |A(i,i)|
+	template<class T>
+	class incomplete_cholesky_preconditioner {
+	private:
+		std::vector<uint32_t> mOffsets;	//!< L rows, diagonal stored last
+		std::vector<uint32_t> mColumns;
+		std::vector<T> mValues;
+		std::vector<uint32_t> mTransposeOffsets;	//!< L^T rows, diagonal stored first
+		std::vector<uint32_t> mTransposeColumns;
+		std::vector<T> mTransposeValues;
+		uint32_t mSize;
+	private:
+		void _factorise(const csr_matrix<T>& aMatrix) {
+			const uint32_t* const offsets = aMatrix.row_offsets();
+			const uint32_t* const columns = aMatrix.column_indices();
+			const T* const values = aMatrix.values();
+
+			mOffsets.assign(mSize + 1, 0);
+			for(uint32_t i = 0; i < mSize; ++i) {
+				bool diagonal = false;
+				for(uint32_t j = offsets[i]; j < offsets[i + 1] && columns[j] <= i; ++j) {
+					mColumns.push_back(columns[j]);
+					mValues.push_back(values[j]);
+					if(columns[j] == i) diagonal = true;
+				}
+				if(! diagonal) {
+					mColumns.push_back(i);
+					mValues.push_back(static_cast<T>(0));
+				}
+				mOffsets[i + 1] = static_cast<uint32_t>(mColumns.size());
+			}
+
+			for(uint32_t i = 0; i < mSize; ++i) {
+				const uint32_t begin = mOffsets[i];
+				const uint32_t last = mOffsets[i + 1] - 1;
+				for(uint32_t j = begin; j <= last; ++j) {
+					const uint32_t k = mColumns[j];
+
+					// Sparse dot of rows i and k over columns < k
+					T sum = static_cast<T>(0);
+					uint32_t a = begin;
+					uint32_t b = mOffsets[k];
+					const uint32_t bEnd = mOffsets[k + 1] - 1;
+					while(a < j && b < bEnd) {
+						if(mColumns[a] == mColumns[b]) sum += mValues[a++] * mValues[b++];
+						else if(mColumns[a] < mColumns[b]) ++a;
+						else ++b;
+					}
+
+					if(j < last) {
+						mValues[j] = (mValues[j] - sum) / mValues[mOffsets[k + 1] - 1];
+					}else {
+						const T pivot = mValues[j] - sum;
+						mValues[j] = static_cast<T>(std::sqrt(pivot > static_cast<T>(0) ? pivot : std::abs(aMatrix.get(i, i)) + static_cast<T>(1e-12)));
+					}
+				}
+			}
+
+			// Transpose for the backward substitution
+			mTransposeOffsets.assign(mSize + 1, 0);
+			for(uint32_t j = 0; j < mColumns.size(); ++j) ++mTransposeOffsets[mColumns[j] + 1];
+			for(uint32_t i = 0; i < mSize; ++i) mTransposeOffsets[i + 1] += mTransposeOffsets[i];
+			mTransposeColumns.resize(mColumns.size());
+			mTransposeValues.resize(mValues.size());
+			std::vector<uint32_t> cursor(mTransposeOffsets.begin(), mTransposeOffsets.end() - 1);
+			for(uint32_t i = 0; i < mSize; ++i) {
+				for(uint32_t j = mOffsets[i]; j < mOffsets[i + 1]; ++j) {
+					const uint32_t slot = cursor[mColumns[j]]++;
+					mTransposeColumns[slot] = i;
+					mTransposeValues[slot] = mValues[j];
+				}
+			}
+		}
+	public:
+		explicit incomplete_cholesky_preconditioner(const csr_matrix<T>& aMatrix) :
+			mSize(aMatrix.rows())
+		{
+			_factorise(aMatrix);
+		}
+
+		template<const uint32_t N>
+		explicit incomplete_cholesky_preconditioner(const matrix<T,N,N>& aMatrix) :
+			mSize(N)
+		{
+			_factorise(csr_matrix<T>(aMatrix));
+		}
+
+		void apply(const T* const aInput, T* const aOutput, const uint32_t aSize) const throw() {
+			// L y = r
+			for(uint32_t i = 0; i < aSize; ++i) {
+				T sum = aInput[i];
+				const uint32_t last = mOffsets[i + 1] - 1;
+				for(uint32_t j = mOffsets[i]; j < last; ++j) sum -= mValues[j] * aOutput[mColumns[j]];
+				aOutput[i] = sum / mValues[last];
+			}
+
+			// L^T z = y
+			for(uint32_t i = aSize; i > 0; --i) {
+				const uint32_t row = i - 1;
+				const uint32_t first = mTransposeOffsets[row];
+				T sum = aOutput[row];
+				for(uint32_t j = first + 1; j < mTransposeOffsets[row + 1]; ++j) sum -= mTransposeValues[j] * aOutput[mTransposeColumns[j]];
+				aOutput[row] = sum / mTransposeValues[first];
+			}
+		}
+	};
+
+	//! \brief Preconditioned conjugate gradient for symmetric positive definite systems
+	//! \param aSolution Initial guess on input, solution on output
+	template<class T, class M, class P>
+	solver_result<T> conjugate_gradient(const M& aMatrix, const T* const aRhs, T* const aSolution, const P& aPreconditioner, solver_workspace<T>& aWorkspace, const uint32_t aMaxIterations, const T aTolerance) {
+		const uint32_t size = _operator_size(aMatrix);
+		SOLAIRE_INSTRUMENT(INSTRUMENT_SOLVER, size);
+		aWorkspace.reserve(size);
+		T* const r = aWorkspace[0];
+		T* const z = aWorkspace[1];
+		T* const p = aWorkspace[2];
+		T* const q = aWorkspace[3];
+
+		solver_result<T> result;
+		result.iterations = 0;
+		result.residual = static_cast<T>(0);
+		result.converged = true;
+
+		const T rhsNorm = aWorkspace.norm(aRhs);
+		if(rhsNorm == static_cast<T>(0)) {
+			for(uint32_t i = 0; i < size; ++i) aSolution[i] = static_cast<T>(0);
+			return result;
+		}
+
+		_operator_multiply(aMatrix, aSolution, q, aWorkspace.get_execution());
+		aWorkspace.combine(aRhs, static_cast<T>(1), q, static_cast<T>(-1), r);
+		result.residual = aWorkspace.norm(r) / rhsNorm;
+		if(result.residual <= aTolerance) return result;
+
+		aPreconditioner.apply(r, z, size);
+		aWorkspace.copy(z, p);
+		T rz = aWorkspace.dot(r, z);
+
+		result.converged = false;
+		while(result.iterations < aMaxIterations) {
+			++result.iterations;
+			_operator_multiply(aMatrix, p, q, aWorkspace.get_execution());
+			const T alpha = rz / aWorkspace.dot(p, q);
+			aWorkspace.axpy(alpha, p, aSolution);
+			aWorkspace.axpy(-alpha, q, r);
+
+			result.residual = aWorkspace.norm(r) / rhsNorm;
+			if(result.residual <= aTolerance) {
+				result.converged = true;
+				break;
+			}
+
+			aPreconditioner.apply(r, z, size);
+			const T rzNext = aWorkspace.dot(r, z);
+			aWorkspace.combine(z, static_cast<T>(1), p, rzNext / rz, p);
+			rz = rzNext;
+		}
+		return result;
+	}
+
+	template<class T, class M>
+	inline solver_result<T> conjugate_gradient(const M& aMatrix, const T* const aRhs, T* const aSolution, solver_workspace<T>& aWorkspace, const uint32_t aMaxIterations, const T aTolerance) {
+		return conjugate_gradient(aMatrix, aRhs, aSolution, identity_preconditioner<T>(), aWorkspace, aMaxIterations, aTolerance);
+	}
+
+	//! \brief Right preconditioned BiCGSTAB for general non-symmetric systems
+	//! \param aSolution Initial guess on input, solution on output
+	template<class T, class M, class P>
+	solver_result<T> bicgstab(const M& aMatrix, const T* const aRhs, T* const aSolution, const P& aPreconditioner, solver_workspace<T>& aWorkspace, const uint32_t aMaxIterations, const T aTolerance) {
+		const uint32_t size = _operator_size(aMatrix);
+		SOLAIRE_INSTRUMENT(INSTRUMENT_SOLVER, size);
+		aWorkspace.reserve(size);
+		T* const r = aWorkspace[0];
+		T* const shadow = aWorkspace[1];
+		T* const p = aWorkspace[2];
+		T* const v = aWorkspace[3];
+		T* const pHat = aWorkspace[4];
+		T* const s = aWorkspace[5];
+		T* const sHat = aWorkspace[6];
+		T* const t = aWorkspace[7];
+
+		solver_result<T> result;
+		result.iterations = 0;
+		result.residual = static_cast<T>(0);
+		result.converged = true;
+
+		const T rhsNorm = aWorkspace.norm(aRhs);
+		if(rhsNorm == static_cast<T>(0)) {
+			for(uint32_t i = 0; i < size; ++i) aSolution[i] = static_cast<T>(0);
+			return result;
+		}
+
+		_operator_multiply(aMatrix, aSolution, v, aWorkspace.get_execution());
+		aWorkspace.combine(aRhs, static_cast<T>(1), v, static_cast<T>(-1), r);
+		result.residual = aWorkspace.norm(r) / rhsNorm;
+		if(result.residual <= aTolerance) return result;
+
+		aWorkspace.copy(r, shadow);
+		for(uint32_t i = 0; i < size; ++i) {
+			p[i] = static_cast<T>(0);
+			v[i] = static_cast<T>(0);
+		}
+		T rho = static_cast<T>(1);
+		T alpha = static_cast<T>(1);
+		T omega = static_cast<T>(1);
+
+		result.converged = false;
+		while(result.iterations < aMaxIterations) {
+			++result.iterations;
+			const T rhoNext = aWorkspace.dot(shadow, r);
+			if(rhoNext == static_cast<T>(0)) break;
+
+			// p = r + beta * (p - omega * v)
+			const T beta = (rhoNext / rho) * (alpha / omega);
+			aWorkspace.axpy(-omega, v, p);
+			aWorkspace.combine(r, static_cast<T>(1), p, beta, p);
+
+			aPreconditioner.apply(p, pHat, size);
+			_operator_multiply(aMatrix, pHat, v, aWorkspace.get_execution());
+			alpha = rhoNext / aWorkspace.dot(shadow, v);
+			aWorkspace.combine(r, static_cast<T>(1), v, -alpha, s);
+
+			const T sNorm = aWorkspace.norm(s) / rhsNorm;
+			if(sNorm <= aTolerance) {
+				aWorkspace.axpy(alpha, pHat, aSolution);
+				result.residual = sNorm;
+				result.converged = true;
+				break;
+			}
+
+			aPreconditioner.apply(s, sHat, size);
+			_operator_multiply(aMatrix, sHat, t, aWorkspace.get_execution());
+			const T tt = aWorkspace.dot(t, t);
+			omega = tt == static_cast<T>(0) ? static_cast<T>(0) : aWorkspace.dot(t, s) / tt;
+			aWorkspace.axpy(alpha, pHat, aSolution);
+			aWorkspace.axpy(omega, sHat, aSolution);
+			aWorkspace.combine(s, static_cast<T>(1), t, -omega, r);
+
+			result.residual = aWorkspace.norm(r) / rhsNorm;
+			if(result.residual <= aTolerance) {
+				result.converged = true;
+				break;
+			}
+			if(omega == static_cast<T>(0)) break;
+			rho = rhoNext;
+		}
+		return result;
+	}
+
+	template<class T, class M>
+	inline solver_result<T> bicgstab(const M& aMatrix, const T* const aRhs, T* const aSolution, solver_workspace<T>& aWorkspace, const uint32_t aMaxIterations, const T aTolerance) {
+		return bicgstab(aMatrix, aRhs, aSolution, identity_preconditioner<T>(), aWorkspace, aMaxIterations, aTolerance);
+	}
+}
+
+#endif
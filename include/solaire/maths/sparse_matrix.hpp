@@ -0,0 +1,349 @@
+#ifndef SOLAIRE_SPARSE_MATRIX_HPP
+#define SOLAIRE_SPARSE_MATRIX_HPP
+
+//Copyright 2016 Adam G. Smith
+//
+//Licensed under the Apache License, Version 2.0 (the "License");
+//you may not use this file except in compliance with the License.
+//You may obtain a copy of the License at
+//
+//http ://www.apache.org/licenses/LICENSE-2.0
+//
+//Unless required by applicable law or agreed to in writing, software
+//distributed under the License is distributed on an "AS IS" BASIS,
+//WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//See the License for the specific language governing permissions and
+//limitations under the License.
+
+#include <algorithm>
+#include <vector>
+#include "solaire/maths/matrix.hpp"
+#include "solaire/maths/parallel.hpp"
+
+#if defined(SOLAIRE_MATHS_AVX2)
+	#include <immintrin.h>
+#endif
+
+namespace solaire {
+
+	template<class T>
+	struct sparse_entry {
+		uint32_t row;
+		uint32_t column;
+		T value;
+	};
+
+	enum {
+		SPARSE_PARALLEL_GRAIN = 2048	//!< Minimum rows handed to a thread by the sparse kernels
+	};
+
+	template<class T>
+	inline T _csr_row_dot(const uint32_t* const aColumns, const T* const aValues, const uint32_t aCount, const T* const aVector) throw() {
+		T sum[4] = {static_cast<T>(0), static_cast<T>(0), static_cast<T>(0), static_cast<T>(0)};
+		uint32_t i = 0;
+		for(; i + 4 <= aCount; i += 4) {
+			sum[0] += aValues[i] * aVector[aColumns[i]];
+			sum[1] += aValues[i + 1] * aVector[aColumns[i + 1]];
+			sum[2] += aValues[i + 2] * aVector[aColumns[i + 2]];
+			sum[3] += aValues[i + 3] * aVector[aColumns[i + 3]];
+		}
+		for(; i < aCount; ++i) sum[0] += aValues[i] * aVector[aColumns[i]];
+		return (sum[0] + sum[1]) + (sum[2] + sum[3]);
+	}
+
+	#if defined(SOLAIRE_MATHS_AVX2)
+		inline float _csr_row_dot(const uint32_t* const aColumns, const float* const aValues, const uint32_t aCount, const float* const aVector) throw() {
+			__m256 sum8 = _mm256_setzero_ps();
+			uint32_t i = 0;
+			for(; i + 8 <= aCount; i += 8) {
+				const __m256i columns = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(aColumns + i));
+				sum8 = _mm256_add_ps(sum8, _mm256_mul_ps(_mm256_loadu_ps(aValues + i), _mm256_i32gather_ps(aVector, columns, 4)));
+			}
+			__m128 sum4 = _mm_add_ps(_mm256_castps256_ps128(sum8), _mm256_extractf128_ps(sum8, 1));
+			sum4 = _mm_add_ps(sum4, _mm_movehl_ps(sum4, sum4));
+			sum4 = _mm_add_ss(sum4, _mm_shuffle_ps(sum4, sum4, 1));
+			float sum = _mm_cvtss_f32(sum4);
+			for(; i < aCount; ++i) sum += aValues[i] * aVector[aColumns[i]];
+			return sum;
+		}
+
+		inline double _csr_row_dot(const uint32_t* const aColumns, const double* const aValues, const uint32_t aCount, const double* const aVector) throw() {
+			__m256d sum4 = _mm256_setzero_pd();
+			uint32_t i = 0;
+			for(; i + 4 <= aCount; i += 4) {
+				const __m128i columns = _mm_loadu_si128(reinterpret_cast<const __m128i*>(aColumns + i));
+				sum4 = _mm256_add_pd(sum4, _mm256_mul_pd(_mm256_loadu_pd(aValues + i), _mm256_i32gather_pd(aVector, columns, 8)));
+			}
+			__m128d sum2 = _mm_add_pd(_mm256_castpd256_pd128(sum4), _mm256_extractf128_pd(sum4, 1));
+			double sum = _mm_cvtsd_f64(_mm_add_sd(sum2, _mm_unpackhi_pd(sum2, sum2)));
+			for(; i < aCount; ++i) sum += aValues[i] * aVector[aColumns[i]];
+			return sum;
+		}
+	#endif
+
+	//! \brief Compressed sparse row matrix
+	template<class T>
+	class csr_matrix {
+	public:
+		typedef T type;
+	private:
+		uint32_t mRows;
+		uint32_t mColumns;
+		std::vector<uint32_t> mRowOffsets;
+		std::vector<uint32_t> mColumnIndices;
+		std::vector<T> mValues;
+	public:
+		csr_matrix() :
+			mRows(0),
+			mColumns(0),
+			mRowOffsets(1, 0)
+		{}
+
+		csr_matrix(const uint32_t aRows, const uint32_t aColumns) :
+			mRows(aRows),
+			mColumns(aColumns),
+			mRowOffsets(aRows + 1, 0)
+		{}
+
+		//! \brief Build from unordered entries, duplicate positions are summed
+		csr_matrix(const uint32_t aRows, const uint32_t aColumns, const sparse_entry<T>* const aEntries, const uint32_t aCount) :
+			mRows(aRows),
+			mColumns(aColumns),
+			mRowOffsets(aRows + 1, 0)
+		{
+			std::vector<sparse_entry<T>> entries(aEntries, aEntries + aCount);
+			std::sort(entries.begin(), entries.end(), [](const sparse_entry<T>& a, const sparse_entry<T>& b) {
+				return a.row == b.row ? a.column < b.column : a.row < b.row;
+			});
+
+			mColumnIndices.reserve(aCount);
+			mValues.reserve(aCount);
+			for(uint32_t i = 0; i < aCount; ++i) {
+				const sparse_entry<T>& e = entries[i];
+				if(i > 0 && e.row == entries[i - 1].row && e.column == entries[i - 1].column) {
+					mValues.back() += e.value;
+				}else {
+					mColumnIndices.push_back(e.column);
+					mValues.push_back(e.value);
+					++mRowOffsets[e.row + 1];
+				}
+			}
+			for(uint32_t i = 0; i < aRows; ++i) mRowOffsets[i + 1] += mRowOffsets[i];
+		}
+
+		template<const uint32_t W, const uint32_t H>
+		explicit csr_matrix(const matrix<T,W,H>& aMatrix) :
+			mRows(H),
+			mColumns(W),
+			mRowOffsets(H + 1, 0)
+		{
+			for(uint32_t i = 0; i < H; ++i) {
+				const T* const row = aMatrix[i];
+				for(uint32_t j = 0; j < W; ++j) {
+					if(row[j] == static_cast<T>(0)) continue;
+					mColumnIndices.push_back(j);
+					mValues.push_back(row[j]);
+				}
+				mRowOffsets[i + 1] = static_cast<uint32_t>(mValues.size());
+			}
+		}
+
+		inline uint32_t rows() const throw() {
+			return mRows;
+		}
+
+		inline uint32_t columns() const throw() {
+			return mColumns;
+		}
+
+		inline uint32_t non_zeros() const throw() {
+			return static_cast<uint32_t>(mValues.size());
+		}
+
+		inline const uint32_t* row_offsets() const throw() {
+			return mRowOffsets.data();
+		}
+
+		inline const uint32_t* column_indices() const throw() {
+			return mColumnIndices.data();
+		}
+
+		inline const T* values() const throw() {
+			return mValues.data();
+		}
+
+		inline T* values() throw() {
+			return mValues.data();
+		}
+
+		T get(const uint32_t aRow, const uint32_t aColumn) const throw() {
+			const uint32_t* const begin = mColumnIndices.data() + mRowOffsets[aRow];
+			const uint32_t* const end = mColumnIndices.data() + mRowOffsets[aRow + 1];
+			const uint32_t* const i = std::lower_bound(begin, end, aColumn);
+			return i != end && *i == aColumn ? mValues[i - mColumnIndices.data()] : static_cast<T>(0);
+		}
+
+		void diagonal(T* const aOutput) const throw() {
+			const uint32_t count = mRows < mColumns ? mRows : mColumns;
+			for(uint32_t i = 0; i < count; ++i) aOutput[i] = get(i, i);
+		}
+
+		//! \brief aOutput = this * aVector, rows are split across threads unless aExecution is EXECUTION_SERIAL
+		void multiply(const T* const aVector, T* const aOutput, const execution aExecution = EXECUTION_PARALLEL) const {
+			SOLAIRE_INSTRUMENT(INSTRUMENT_SPARSE_MULTIPLY, mValues.size());
+			const uint32_t* const offsets = mRowOffsets.data();
+			const uint32_t* const columns = mColumnIndices.data();
+			const T* const values = mValues.data();
+			parallel_for(aExecution, mRows, SPARSE_PARALLEL_GRAIN, [=](const uint32_t aBegin, const uint32_t aEnd) {
+				for(uint32_t i = aBegin; i < aEnd; ++i) {
+					const uint32_t offset = offsets[i];
+					aOutput[i] = _csr_row_dot(columns + offset, values + offset, offsets[i + 1] - offset, aVector);
+				}
+			});
+		}
+
+		//! \brief aOutput = this * aDense, both dense operands are row major with aWidth columns
+		void multiply(const T* const aDense, T* const aOutput, const uint32_t aWidth, const execution aExecution = EXECUTION_PARALLEL) const {
+			SOLAIRE_INSTRUMENT(INSTRUMENT_SPARSE_MULTIPLY, static_cast<uint64_t>(mValues.size()) * aWidth);
+			const uint32_t* const offsets = mRowOffsets.data();
+			const uint32_t* const columns = mColumnIndices.data();
+			const T* const values = mValues.data();
+			parallel_for(aExecution, mRows, SPARSE_PARALLEL_GRAIN / (aWidth == 0 ? 1 : aWidth) + 1, [=](const uint32_t aBegin, const uint32_t aEnd) {
+				for(uint32_t i = aBegin; i < aEnd; ++i) {
+					T* const out = aOutput + static_cast<size_t>(i) * aWidth;
+					for(uint32_t k = 0; k < aWidth; ++k) out[k] = static_cast<T>(0);
+					for(uint32_t j = offsets[i]; j < offsets[i + 1]; ++j) {
+						const T value = values[j];
+						const T* const in = aDense + static_cast<size_t>(columns[j]) * aWidth;
+						for(uint32_t k = 0; k < aWidth; ++k) out[k] += value * in[k];
+					}
+				}
+			});
+		}
+
+		//! \brief aOutput = this * aDense, aOutput is row major with W2 columns
+		//! \return False without writing aOutput if H2 does not match columns()
+		template<const uint32_t W2, const uint32_t H2>
+		bool multiply(const matrix<T,W2,H2>& aDense, T* const aOutput, const execution aExecution = EXECUTION_PARALLEL) const {
+			if(H2 != mColumns) return false;
+			multiply(aDense[0], aOutput, W2, aExecution);
+			return true;
+		}
+	};
+
+	//! \brief Block compressed sparse row matrix with dense B x B blocks
+	//! \detail Edge blocks are zero padded when the dimensions are not a multiple of B
+	template<class T, const uint32_t B>
+	class bsr_matrix {
+	public:
+		typedef T type;
+		enum{BLOCK_SIZE = B};
+	private:
+		uint32_t mRows;
+		uint32_t mColumns;
+		std::vector<uint32_t> mBlockOffsets;
+		std::vector<uint32_t> mBlockColumns;
+		std::vector<T> mValues;	//!< B * B row major values per block
+	public:
+		bsr_matrix() :
+			mRows(0),
+			mColumns(0),
+			mBlockOffsets(1, 0)
+		{}
+
+		explicit bsr_matrix(const csr_matrix<T>& aOther) :
+			mRows(aOther.rows()),
+			mColumns(aOther.columns()),
+			mBlockOffsets((aOther.rows() + B - 1) / B + 1, 0)
+		{
+			const uint32_t blockRows = (mRows + B - 1) / B;
+			const uint32_t blockColumns = (mColumns + B - 1) / B;
+			std::vector<uint32_t> slots(blockColumns, 0xFFFFFFFF);
+			const uint32_t* const offsets = aOther.row_offsets();
+			const uint32_t* const columns = aOther.column_indices();
+			const T* const values = aOther.values();
+
+			for(uint32_t i = 0; i < blockRows; ++i) {
+				const uint32_t first = static_cast<uint32_t>(mBlockColumns.size());
+				const uint32_t rowEnd = (i + 1) * B < mRows ? (i + 1) * B : mRows;
+
+				// Find the distinct block columns of this block row
+				for(uint32_t r = i * B; r < rowEnd; ++r) {
+					for(uint32_t j = offsets[r]; j < offsets[r + 1]; ++j) {
+						const uint32_t block = columns[j] / B;
+						if(slots[block] == 0xFFFFFFFF) {
+							slots[block] = 0;
+							mBlockColumns.push_back(block);
+						}
+					}
+				}
+				std::sort(mBlockColumns.begin() + first, mBlockColumns.end());
+				for(uint32_t j = first; j < mBlockColumns.size(); ++j) slots[mBlockColumns[j]] = j;
+				mValues.resize(mBlockColumns.size() * B * B, static_cast<T>(0));
+
+				for(uint32_t r = i * B; r < rowEnd; ++r) {
+					for(uint32_t j = offsets[r]; j < offsets[r + 1]; ++j) {
+						const uint32_t block = slots[columns[j] / B];
+						mValues[block * B * B + (r % B) * B + columns[j] % B] = values[j];
+					}
+				}
+				for(uint32_t j = first; j < mBlockColumns.size(); ++j) slots[mBlockColumns[j]] = 0xFFFFFFFF;
+				mBlockOffsets[i + 1] = static_cast<uint32_t>(mBlockColumns.size());
+			}
+		}
+
+		template<const uint32_t W, const uint32_t H>
+		explicit bsr_matrix(const matrix<T,W,H>& aMatrix) :
+			bsr_matrix(csr_matrix<T>(aMatrix))
+		{}
+
+		inline uint32_t rows() const throw() {
+			return mRows;
+		}
+
+		inline uint32_t columns() const throw() {
+			return mColumns;
+		}
+
+		inline uint32_t blocks() const throw() {
+			return static_cast<uint32_t>(mBlockColumns.size());
+		}
+
+		//! \brief aOutput = this * aVector, block rows are split across threads unless aExecution is EXECUTION_SERIAL
+		void multiply(const T* const aVector, T* const aOutput, const execution aExecution = EXECUTION_PARALLEL) const {
+			SOLAIRE_INSTRUMENT(INSTRUMENT_SPARSE_MULTIPLY, mValues.size());
+			const uint32_t blockRows = (mRows + B - 1) / B;
+			const uint32_t* const offsets = mBlockOffsets.data();
+			const uint32_t* const blockColumns = mBlockColumns.data();
+			const T* const values = mValues.data();
+			const uint32_t rows = mRows;
+			const uint32_t columns = mColumns;
+			parallel_for(aExecution, blockRows, SPARSE_PARALLEL_GRAIN / B + 1, [=](const uint32_t aBegin, const uint32_t aEnd) {
+				for(uint32_t i = aBegin; i < aEnd; ++i) {
+					T sum[B];
+					for(uint32_t r = 0; r < B; ++r) sum[r] = static_cast<T>(0);
+
+					for(uint32_t j = offsets[i]; j < offsets[i + 1]; ++j) {
+						const T* const block = values + static_cast<size_t>(j) * B * B;
+						const uint32_t column = blockColumns[j] * B;
+						if(column + B <= columns) {
+							const T* const x = aVector + column;
+							for(uint32_t r = 0; r < B; ++r) {
+								for(uint32_t c = 0; c < B; ++c) sum[r] += block[r * B + c] * x[c];
+							}
+						}else {
+							for(uint32_t r = 0; r < B; ++r) {
+								for(uint32_t c = 0; column + c < columns; ++c) sum[r] += block[r * B + c] * aVector[column + c];
+							}
+						}
+					}
+
+					const uint32_t row = i * B;
+					for(uint32_t r = 0; r < B && row + r < rows; ++r) aOutput[row + r] = sum[r];
+				}
+			});
+		}
+	};
+}
+
+#endif
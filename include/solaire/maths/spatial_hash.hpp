@@ -0,0 +1,179 @@
+#ifndef SOLAIRE_SPATIAL_HASH_HPP
+#define SOLAIRE_SPATIAL_HASH_HPP
+
+//Copyright 2016 Adam G. Smith
+//
+//Licensed under the Apache License, Version 2.0 (the "License");
+//you may not use this file except in compliance with the License.
+//You may obtain a copy of the License at
+//
+//http ://www.apache.org/licenses/LICENSE-2.0
+//
+//Unless required by applicable law or agreed to in writing, software
+//distributed under the License is distributed on an "AS IS" BASIS,
+//WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//See the License for the specific language governing permissions and
+//limitations under the License.
+
+#include <cmath>
+#include <vector>
+#include "solaire/maths/hash.hpp"
+
+namespace solaire {
+
+	//! \brief Uniform grid of points stored in a flat open addressing table keyed by integer cell coordinates
+	//! \detail Points are sorted by cell during build so each cell is a contiguous range.
+	//! build() reuses the storage of the previous build.
+	template<class T, const uint32_t S>
+	class spatial_hash_grid {
+	public:
+		typedef T type;
+		typedef vector<T,S> point_t;
+		typedef vector<int32_t,S> cell_t;
+		enum {
+			MIN_SLOTS = 16,
+			INVALID = 0xFFFFFFFF
+		};
+	private:
+		struct slot {
+			cell_t cell;
+			uint32_t begin;
+			uint32_t count;		//!< 0 for an empty slot
+		};
+
+		std::vector<slot> mSlots;
+		std::vector<point_t> mPoints;	//!< Points in cell order
+		std::vector<uint32_t> mIndices;	//!< Original index of each point in cell order
+		std::vector<cell_t> mCells;
+		std::vector<uint32_t> mHashes;
+		T mCellSize;
+		T mInverseCellSize;
+		uint32_t mMask;
+	private:
+		uint32_t _find(const cell_t& aCell, const uint32_t aHash) const throw() {
+			uint32_t i = aHash & mMask;
+			while(mSlots[i].count != 0) {
+				if(mSlots[i].cell == aCell) return i;
+				i = (i + 1) & mMask;
+			}
+			return INVALID;
+		}
+	public:
+		explicit spatial_hash_grid(const T aCellSize) :
+			mCellSize(aCellSize),
+			mInverseCellSize(static_cast<T>(1) / aCellSize),
+			mMask(0)
+		{}
+
+		inline T get_cell_size() const throw() {
+			return mCellSize;
+		}
+
+		cell_t cell_of(const point_t& aPoint) const throw() {
+			cell_t tmp;
+			for(uint32_t i = 0; i < S; ++i) tmp[i] = static_cast<int32_t>(std::floor(aPoint[i] * mInverseCellSize));
+			return tmp;
+		}
+
+		void build(const point_t* const aPoints, const uint32_t aCount) {
+			mCells.resize(aCount);
+			mHashes.resize(aCount);
+			mPoints.resize(aCount);
+			mIndices.resize(aCount);
+
+			for(uint32_t i = 0; i < aCount; ++i) mCells[i] = cell_of(aPoints[i]);
+			hash_cells(mCells.data(), mHashes.data(), aCount);
+
+			uint32_t capacity = MIN_SLOTS;
+			while(capacity < aCount * 2) capacity <<= 1;
+			slot empty;
+			empty.begin = 0;
+			empty.count = 0;
+			mSlots.assign(capacity, empty);
+			mMask = capacity - 1;
+
+			// Count points per cell, mHashes is reused to hold the slot of each point
+			for(uint32_t i = 0; i < aCount; ++i) {
+				uint32_t j = mHashes[i] & mMask;
+				while(mSlots[j].count != 0 && ! (mSlots[j].cell == mCells[i])) j = (j + 1) & mMask;
+				slot& s = mSlots[j];
+				if(s.count == 0) s.cell = mCells[i];
+				++s.count;
+				mHashes[i] = j;
+			}
+
+			// Each slot's begin temporarily holds the end of its range and is decremented while scattering
+			uint32_t offset = 0;
+			for(slot& i : mSlots) {
+				offset += i.count;
+				i.begin = offset;
+			}
+			for(uint32_t i = aCount; i > 0; --i) {
+				const uint32_t index = i - 1;
+				const uint32_t position = --mSlots[mHashes[index]].begin;
+				mPoints[position] = aPoints[index];
+				mIndices[position] = index;
+			}
+		}
+
+		inline uint32_t size() const throw() {
+			return static_cast<uint32_t>(mPoints.size());
+		}
+
+		//! \brief Points in cell order, use get_indices to map back to the build order
+		inline const point_t* get_points() const throw() {
+			return mPoints.data();
+		}
+
+		inline const uint32_t* get_indices() const throw() {
+			return mIndices.data();
+		}
+
+		//! \brief Find the contiguous range of points in a cell
+		//! \return The number of points in the cell, aBegin is set to the first point's position in get_points()
+		uint32_t find(const cell_t& aCell, uint32_t& aBegin) const throw() {
+			if(mSlots.empty()) return 0;
+			const uint32_t i = _find(aCell, hash_cell(aCell));
+			if(i == INVALID) return 0;
+			aBegin = mSlots[i].begin;
+			return mSlots[i].count;
+		}
+
+		//! \brief Call aCallback(index, distanceSquared) for every point within aRadius of aCentre
+		template<class F>
+		void query(const point_t& aCentre, const T aRadius, const F& aCallback) const {
+			if(mSlots.empty()) return;
+			const T radiusSq = aRadius * aRadius;
+			const cell_t lower = cell_of(aCentre - aRadius);
+			const cell_t upper = cell_of(aCentre + aRadius);
+			cell_t cell = lower;
+
+			while(true) {
+				uint32_t begin = 0;
+				const uint32_t count = find(cell, begin);
+				for(uint32_t i = begin; i < begin + count; ++i) {
+					T distance = static_cast<T>(0);
+					for(uint32_t j = 0; j < S; ++j) {
+						const T d = mPoints[i][j] - aCentre[j];
+						distance += d * d;
+					}
+					if(distance <= radiusSq) aCallback(mIndices[i], distance);
+				}
+
+				// Step to the next cell in the box
+				uint32_t axis = 0;
+				while(axis < S && cell[axis] == upper[axis]) {
+					cell[axis] = lower[axis];
+					++axis;
+				}
+				if(axis == S) break;
+				++cell[axis];
+			}
+		}
+	};
+
+	typedef spatial_hash_grid<float, 2> spatial_hash_grid_2f;
+	typedef spatial_hash_grid<float, 3> spatial_hash_grid_3f;
+}
+
+#endif
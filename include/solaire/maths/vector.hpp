@@ -16,6 +16,19 @@
 //limitations under the License.
 
 #include "solaire/maths/maths.hpp"
+#include "solaire/maths/half.hpp"
+#include "solaire/maths/fixed.hpp"
+#include "solaire/maths/approximate.hpp"
+#include "solaire/maths/mask.hpp"
+#include "solaire/maths/instrument.hpp"
+
+#if defined(SOLAIRE_MATHS_AVX)
+	#include <immintrin.h>
+#elif defined(SOLAIRE_MATHS_SSE2)
+	#include <emmintrin.h>
+#endif
+
+extern "C" SOLAIRE_EXPORT_API void SOLAIRE_EXPORT_CALL solaire_shuffle_bytes4(const uint8_t*, uint8_t*, const uint32_t, const uint8_t*);
 
 namespace solaire {
 
@@ -31,6 +44,107 @@ namespace solaire {
 		#pragma message("warning: " __FILE__  " Advanced constexpr functionality disabled. Requires C++14 or greater")
 	#endif
 
+	// Compile-time swizzle
+
+	template<const uint32_t S, const uint32_t... I>
+	struct _swizzle_valid;
+
+	template<const uint32_t S>
+	struct _swizzle_valid<S> {
+		enum { value = 1 };
+	};
+
+	template<const uint32_t S, const uint32_t I, const uint32_t... I2>
+	struct _swizzle_valid<S, I, I2...> {
+		enum { value = I < S && _swizzle_valid<S, I2...>::value };
+	};
+
+	//! \brief Reorders the S elements of aInput into sizeof...(I) elements of aOutput
+	//! \detail Specialised with a single shuffle / permute instruction for SIMD sized vectors
+	template<class T, const uint32_t S, const uint32_t... I>
+	struct vector_shuffle {
+		static inline void apply(const T* const aInput, T* const aOutput) throw() {
+			const T tmp[sizeof...(I)] = { aInput[I]... };
+			for(uint32_t i = 0; i < sizeof...(I); ++i) aOutput[i] = tmp[i];
+		}
+	};
+
+	#if defined(SOLAIRE_MATHS_SSE2)
+		template<const uint32_t A, const uint32_t B, const uint32_t C, const uint32_t D>
+		struct vector_shuffle<float, 4, A, B, C, D> {
+			static inline void apply(const float* const aInput, float* const aOutput) throw() {
+				const __m128 tmp = _mm_loadu_ps(aInput);
+				_mm_storeu_ps(aOutput, _mm_shuffle_ps(tmp, tmp, _MM_SHUFFLE(D, C, B, A)));
+			}
+		};
+
+		template<const uint32_t A, const uint32_t B>
+		struct vector_shuffle<double, 2, A, B> {
+			static inline void apply(const double* const aInput, double* const aOutput) throw() {
+				const __m128d tmp = _mm_loadu_pd(aInput);
+				_mm_storeu_pd(aOutput, _mm_shuffle_pd(tmp, tmp, A | (B << 1)));
+			}
+		};
+
+		#define SOLAIRE_VECTOR_SHUFFLE_EPI32(aType)\
+			template<const uint32_t A, const uint32_t B, const uint32_t C, const uint32_t D>\
+			struct vector_shuffle<aType, 4, A, B, C, D> {\
+				static inline void apply(const aType* const aInput, aType* const aOutput) throw() {\
+					const __m128i tmp = _mm_loadu_si128(reinterpret_cast<const __m128i*>(aInput));\
+					_mm_storeu_si128(reinterpret_cast<__m128i*>(aOutput), _mm_shuffle_epi32(tmp, _MM_SHUFFLE(D, C, B, A)));\
+				}\
+			};
+
+		SOLAIRE_VECTOR_SHUFFLE_EPI32(int32_t)
+		SOLAIRE_VECTOR_SHUFFLE_EPI32(uint32_t)
+
+		#undef SOLAIRE_VECTOR_SHUFFLE_EPI32
+	#endif
+
+	#if defined(SOLAIRE_MATHS_AVX2)
+		template<const uint32_t A, const uint32_t B, const uint32_t C, const uint32_t D>
+		struct vector_shuffle<double, 4, A, B, C, D> {
+			static inline void apply(const double* const aInput, double* const aOutput) throw() {
+				_mm256_storeu_pd(aOutput, _mm256_permute4x64_pd(_mm256_loadu_pd(aInput), _MM_SHUFFLE(D, C, B, A)));
+			}
+		};
+
+		#define SOLAIRE_VECTOR_SHUFFLE_EPI64(aType)\
+			template<const uint32_t A, const uint32_t B, const uint32_t C, const uint32_t D>\
+			struct vector_shuffle<aType, 4, A, B, C, D> {\
+				static inline void apply(const aType* const aInput, aType* const aOutput) throw() {\
+					const __m256i tmp = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(aInput));\
+					_mm256_storeu_si256(reinterpret_cast<__m256i*>(aOutput), _mm256_permute4x64_epi64(tmp, _MM_SHUFFLE(D, C, B, A)));\
+				}\
+			};
+
+		SOLAIRE_VECTOR_SHUFFLE_EPI64(int64_t)
+		SOLAIRE_VECTOR_SHUFFLE_EPI64(uint64_t)
+
+		#undef SOLAIRE_VECTOR_SHUFFLE_EPI64
+
+		template<const uint32_t A, const uint32_t B, const uint32_t C, const uint32_t D, const uint32_t E, const uint32_t F, const uint32_t G, const uint32_t H>
+		struct vector_shuffle<float, 8, A, B, C, D, E, F, G, H> {
+			static inline void apply(const float* const aInput, float* const aOutput) throw() {
+				_mm256_storeu_ps(aOutput, _mm256_permutevar8x32_ps(_mm256_loadu_ps(aInput), _mm256_setr_epi32(A, B, C, D, E, F, G, H)));
+			}
+		};
+
+		#define SOLAIRE_VECTOR_SHUFFLE_EPI32X8(aType)\
+			template<const uint32_t A, const uint32_t B, const uint32_t C, const uint32_t D, const uint32_t E, const uint32_t F, const uint32_t G, const uint32_t H>\
+			struct vector_shuffle<aType, 8, A, B, C, D, E, F, G, H> {\
+				static inline void apply(const aType* const aInput, aType* const aOutput) throw() {\
+					const __m256i tmp = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(aInput));\
+					_mm256_storeu_si256(reinterpret_cast<__m256i*>(aOutput), _mm256_permutevar8x32_epi32(tmp, _mm256_setr_epi32(A, B, C, D, E, F, G, H)));\
+				}\
+			};
+
+		SOLAIRE_VECTOR_SHUFFLE_EPI32X8(int32_t)
+		SOLAIRE_VECTOR_SHUFFLE_EPI32X8(uint32_t)
+
+		#undef SOLAIRE_VECTOR_SHUFFLE_EPI32X8
+	#endif
+
 	template<class T, const uint32_t S>
 	class vector {
 	public:
@@ -118,58 +232,64 @@ namespace solaire {
 		}
 
 		template<class T2 = T, typename ENABLE = typename std::enable_if<std::is_arithmetic<T2>::value || std::is_same<T,T2>::value>::type>
-		vector<bool, S> operator==(const T2 aScalar) const throw() {
-			vector<bool, S> tmp;
-			for(uint32_t i = 0; i < S; ++i) tmp[i] = mElements[i] == aScalar;
-			return tmp;
+		vector_mask<S> operator==(const T2 aScalar) const throw() {
+			typename vector_mask<S>::type tmp = 0;
+			for(uint32_t i = 0; i < S; ++i) tmp |= static_cast<typename vector_mask<S>::type>(mElements[i] == aScalar) << i;
+			return vector_mask<S>(tmp);
 		}
 
 		template<class T2 = T, typename ENABLE = typename std::enable_if<std::is_arithmetic<T2>::value || std::is_same<T,T2>::value>::type>
-		vector<bool, S> operator!=(const T2 aScalar) const throw() {
-			vector<bool, S> tmp;
-			for(uint32_t i = 0; i < S; ++i) tmp[i] = mElements[i] != aScalar;
-			return tmp;
+		vector_mask<S> operator!=(const T2 aScalar) const throw() {
+			typename vector_mask<S>::type tmp = 0;
+			for(uint32_t i = 0; i < S; ++i) tmp |= static_cast<typename vector_mask<S>::type>(mElements[i] != aScalar) << i;
+			return vector_mask<S>(tmp);
 		}
 
 		template<class T2 = T, typename ENABLE = typename std::enable_if<std::is_arithmetic<T2>::value || std::is_same<T,T2>::value>::type>
-		vector<bool, S> operator<(const T2 aScalar) const throw() {
-			vector<bool, S> tmp;
-			for(uint32_t i = 0; i < S; ++i) tmp[i] = mElements[i] < aScalar;
-			return tmp;
+		vector_mask<S> operator<(const T2 aScalar) const throw() {
+			typename vector_mask<S>::type tmp = 0;
+			for(uint32_t i = 0; i < S; ++i) tmp |= static_cast<typename vector_mask<S>::type>(mElements[i] < aScalar) << i;
+			return vector_mask<S>(tmp);
 		}
 
 		template<class T2 = T, typename ENABLE = typename std::enable_if<std::is_arithmetic<T2>::value || std::is_same<T,T2>::value>::type>
-		vector<bool, S> operator>(const T2 aScalar) const throw() {
-			vector<bool, S> tmp;
-			for(uint32_t i = 0; i < S; ++i) tmp[i] = mElements[i] > aScalar;
-			return tmp;
+		vector_mask<S> operator>(const T2 aScalar) const throw() {
+			typename vector_mask<S>::type tmp = 0;
+			for(uint32_t i = 0; i < S; ++i) tmp |= static_cast<typename vector_mask<S>::type>(mElements[i] > aScalar) << i;
+			return vector_mask<S>(tmp);
 		}
 
 		template<class T2 = T, typename ENABLE = typename std::enable_if<std::is_arithmetic<T2>::value || std::is_same<T,T2>::value>::type>
-		vector<bool, S> operator<=(const T2 aScalar) const throw() {
-			vector<bool, S> tmp;
-			for(uint32_t i = 0; i < S; ++i) tmp[i] = mElements[i] <= aScalar;
-			return tmp;
+		vector_mask<S> operator<=(const T2 aScalar) const throw() {
+			typename vector_mask<S>::type tmp = 0;
+			for(uint32_t i = 0; i < S; ++i) tmp |= static_cast<typename vector_mask<S>::type>(mElements[i] <= aScalar) << i;
+			return vector_mask<S>(tmp);
 		}
 
 		template<class T2 = T, typename ENABLE = typename std::enable_if<std::is_arithmetic<T2>::value || std::is_same<T, T2>::value>::type>
-		vector<bool, S> operator>=(const T2 aScalar) const throw() {
-			vector<bool, S> tmp;
-			for (uint32_t i = 0; i < S; ++i) tmp[i] = mElements[i] >= aScalar;
-			return tmp;
+		vector_mask<S> operator>=(const T2 aScalar) const throw() {
+			typename vector_mask<S>::type tmp = 0;
+			for(uint32_t i = 0; i < S; ++i) tmp |= static_cast<typename vector_mask<S>::type>(mElements[i] >= aScalar) << i;
+			return vector_mask<S>(tmp);
 		}
 
 		#if SOLAIRE_CPP_VER >= SOLAIRE_CPP_14 || SOLAIRE_CPP_VER < SOLAIRE_CPP_11
+			// Reductions use four independent accumulators to break the dependency chain on long vectors
 			SOLAIRE_CONSTEXPR_I14 T sum() const throw() {
-				T sum = static_cast<T>(0);
-				for(uint32_t i = 0; i < S; ++i) sum += mElements[i];
-				return sum;
+				T sum[4] = {static_cast<T>(0), static_cast<T>(0), static_cast<T>(0), static_cast<T>(0)};
+				uint32_t i = 0;
+				for(; i + 4 <= S; i += 4) {
+					sum[0] += mElements[i];
+					sum[1] += mElements[i + 1];
+					sum[2] += mElements[i + 2];
+					sum[3] += mElements[i + 3];
+				}
+				for(; i < S; ++i) sum[i % 4] += mElements[i];
+				return (sum[0] + sum[1]) + (sum[2] + sum[3]);
 			}
 
 			SOLAIRE_CONSTEXPR_I14 T magnitude_sq() const throw() {
-				T mag = static_cast<T>(0);
-				for(uint32_t i = 0; i < S; ++i) mag += mElements[i] * mElements[i];
-				return mag;
+				return dot_product(*this);
 			}
 			SOLAIRE_CONSTEXPR_I14 bool operator==(const vector<T,S>& aOther) const throw() {
 				for(uint32_t i = 0; i < S; ++i) if(mElements[i] != aOther[i]) return false;
@@ -182,9 +302,16 @@ namespace solaire {
 			}
 
 			SOLAIRE_CONSTEXPR_I14 T dot_product(const vector<T, S>& aOther) const throw() {
-				T dot = static_cast<T>(0);
-				for(uint32_t i = 0; i < S; ++i) dot += mElements[i] * aOther[i];
-				return dot;
+				T dot[4] = {static_cast<T>(0), static_cast<T>(0), static_cast<T>(0), static_cast<T>(0)};
+				uint32_t i = 0;
+				for(; i + 4 <= S; i += 4) {
+					dot[0] += mElements[i] * aOther[i];
+					dot[1] += mElements[i + 1] * aOther[i + 1];
+					dot[2] += mElements[i + 2] * aOther[i + 2];
+					dot[3] += mElements[i + 3] * aOther[i + 3];
+				}
+				for(; i < S; ++i) dot[i % 4] += mElements[i] * aOther[i];
+				return (dot[0] + dot[1]) + (dot[2] + dot[3]);
 			}
 		#else
 			SOLAIRE_CONSTEXPR_I11 T sum(const uint32_t aIndex = S - 1) const throw() {
@@ -216,8 +343,15 @@ namespace solaire {
 			return SOLAIRE_CONSTEXPR_sqrt(magnitude_sq());
 		}
 
+		template<const precision P = PRECISION_EXACT>
+		inline T inverse_magnitude() const throw() {
+			typedef typename std::conditional<std::is_same<T, double>::value, double, float>::type real_t;
+			return static_cast<T>(rsqrt<P>(static_cast<real_t>(magnitude_sq())));
+		}
+
+		template<const precision P = PRECISION_EXACT>
 		inline vector<T,S> normalise() const throw() {
-			return vector<T,S>(*this) /= this->magitude();
+			return P == PRECISION_EXACT ? vector<T,S>(*this) /= magnitude() : vector<T,S>(*this) *= inverse_magnitude<P>();
 		}
 
 		inline vector<T,S> normalise(const T aMagnitude) const throw() {
@@ -237,6 +371,55 @@ namespace solaire {
 				return swizzle(vector<uint32_t, sizeof...(PARAMS)>(aParams...));
 			}
 
+			//! \brief Swizzle with indices known at compile time, eg. v.swizzle<2,1,0,3>()
+			template<const uint32_t... I>
+			inline vector<T, sizeof...(I)> swizzle() const throw() {
+				static_assert(sizeof...(I) > 0, "solaire::vector::swizzle : At least one index is required");
+				static_assert(_swizzle_valid<S, I...>::value, "solaire::vector::swizzle : Index out of bounds");
+				vector<T, sizeof...(I)> tmp;
+				vector_shuffle<T, S, I...>::apply(mElements, reinterpret_cast<T*>(&tmp));
+				return tmp;
+			}
+
+			// Named swizzles, eg. v.xzy(), only instantiated when used so out of bounds components fail in swizzle
+			#define SOLAIRE_SWIZZLE_2_(aA, aI, aB, aJ)\
+				inline vector<T,2> aA ## aB() const throw() { return swizzle<aI, aJ>(); }
+			#define SOLAIRE_SWIZZLE_3_(aA, aI, aB, aJ, aC, aK)\
+				inline vector<T,3> aA ## aB ## aC() const throw() { return swizzle<aI, aJ, aK>(); }
+			#define SOLAIRE_SWIZZLE_4_(aA, aI, aB, aJ, aC, aK, aD, aL)\
+				inline vector<T,4> aA ## aB ## aC ## aD() const throw() { return swizzle<aI, aJ, aK, aL>(); }
+
+			#define SOLAIRE_SWIZZLE_2(aA, aI)\
+				SOLAIRE_SWIZZLE_2_(aA, aI, x, 0) SOLAIRE_SWIZZLE_2_(aA, aI, y, 1) SOLAIRE_SWIZZLE_2_(aA, aI, z, 2) SOLAIRE_SWIZZLE_2_(aA, aI, w, 3)
+			#define SOLAIRE_SWIZZLE_3B(aA, aI, aB, aJ)\
+				SOLAIRE_SWIZZLE_3_(aA, aI, aB, aJ, x, 0) SOLAIRE_SWIZZLE_3_(aA, aI, aB, aJ, y, 1) SOLAIRE_SWIZZLE_3_(aA, aI, aB, aJ, z, 2) SOLAIRE_SWIZZLE_3_(aA, aI, aB, aJ, w, 3)
+			#define SOLAIRE_SWIZZLE_3(aA, aI)\
+				SOLAIRE_SWIZZLE_3B(aA, aI, x, 0) SOLAIRE_SWIZZLE_3B(aA, aI, y, 1) SOLAIRE_SWIZZLE_3B(aA, aI, z, 2) SOLAIRE_SWIZZLE_3B(aA, aI, w, 3)
+			#define SOLAIRE_SWIZZLE_4C(aA, aI, aB, aJ, aC, aK)\
+				SOLAIRE_SWIZZLE_4_(aA, aI, aB, aJ, aC, aK, x, 0) SOLAIRE_SWIZZLE_4_(aA, aI, aB, aJ, aC, aK, y, 1) SOLAIRE_SWIZZLE_4_(aA, aI, aB, aJ, aC, aK, z, 2) SOLAIRE_SWIZZLE_4_(aA, aI, aB, aJ, aC, aK, w, 3)
+			#define SOLAIRE_SWIZZLE_4B(aA, aI, aB, aJ)\
+				SOLAIRE_SWIZZLE_4C(aA, aI, aB, aJ, x, 0) SOLAIRE_SWIZZLE_4C(aA, aI, aB, aJ, y, 1) SOLAIRE_SWIZZLE_4C(aA, aI, aB, aJ, z, 2) SOLAIRE_SWIZZLE_4C(aA, aI, aB, aJ, w, 3)
+			#define SOLAIRE_SWIZZLE_4(aA, aI)\
+				SOLAIRE_SWIZZLE_4B(aA, aI, x, 0) SOLAIRE_SWIZZLE_4B(aA, aI, y, 1) SOLAIRE_SWIZZLE_4B(aA, aI, z, 2) SOLAIRE_SWIZZLE_4B(aA, aI, w, 3)
+			#define SOLAIRE_SWIZZLE(aA, aI)\
+				SOLAIRE_SWIZZLE_2(aA, aI) SOLAIRE_SWIZZLE_3(aA, aI) SOLAIRE_SWIZZLE_4(aA, aI)
+
+			SOLAIRE_SWIZZLE(x, 0)
+			SOLAIRE_SWIZZLE(y, 1)
+			SOLAIRE_SWIZZLE(z, 2)
+			SOLAIRE_SWIZZLE(w, 3)
+
+			#undef SOLAIRE_SWIZZLE_2_
+			#undef SOLAIRE_SWIZZLE_3_
+			#undef SOLAIRE_SWIZZLE_4_
+			#undef SOLAIRE_SWIZZLE_2
+			#undef SOLAIRE_SWIZZLE_3B
+			#undef SOLAIRE_SWIZZLE_3
+			#undef SOLAIRE_SWIZZLE_4C
+			#undef SOLAIRE_SWIZZLE_4B
+			#undef SOLAIRE_SWIZZLE_4
+			#undef SOLAIRE_SWIZZLE
+
 			template<class T2 = T>
 			SOLAIRE_CONSTEXPR_I11 typename std::enable_if<std::is_same<T2, T>::value && S == 3, vector<T,3>>::type
 			cross_product(const vector<T,3>& aOther) const throw() {
@@ -445,6 +628,118 @@ namespace solaire {
 		return tmp;
 	}
 
+	#define SOLAIRE_VECTOR_COMPARE(aName, aOp)\
+		template<class T, const uint32_t S>\
+		vector_mask<S> aName(const vector<T,S>& aFirst, const vector<T,S>& aSecond) throw() {\
+			typename vector_mask<S>::type tmp = 0;\
+			for(uint32_t i = 0; i < S; ++i) tmp |= static_cast<typename vector_mask<S>::type>(aFirst[i] aOp aSecond[i]) << i;\
+			return vector_mask<S>(tmp);\
+		}
+
+	SOLAIRE_VECTOR_COMPARE(equal_to, ==)
+	SOLAIRE_VECTOR_COMPARE(not_equal_to, !=)
+	SOLAIRE_VECTOR_COMPARE(less, <)
+	SOLAIRE_VECTOR_COMPARE(greater, >)
+	SOLAIRE_VECTOR_COMPARE(less_equal, <=)
+	SOLAIRE_VECTOR_COMPARE(greater_equal, >=)
+
+	#undef SOLAIRE_VECTOR_COMPARE
+
+	//! \brief Lane i of the result is aTrue[i] if aMask[i] is set, otherwise aFalse[i]
+	template<class T, const uint32_t S>
+	vector<T,S> select(const vector_mask<S> aMask, const vector<T,S>& aTrue, const vector<T,S>& aFalse) throw() {
+		vector<T,S> tmp;
+		for(uint32_t i = 0; i < S; ++i) tmp[i] = aMask[i] ? aTrue[i] : aFalse[i];
+		return tmp;
+	}
+
+	template<class T, const uint32_t S>
+	vector<T,S> select(const vector_mask<S> aMask, const vector<T,S>& aTrue, const T aFalse) throw() {
+		vector<T,S> tmp;
+		for(uint32_t i = 0; i < S; ++i) tmp[i] = aMask[i] ? aTrue[i] : aFalse;
+		return tmp;
+	}
+
+	template<class T, const uint32_t S>
+	vector<T,S> select(const vector_mask<S> aMask, const T aTrue, const vector<T,S>& aFalse) throw() {
+		vector<T,S> tmp;
+		for(uint32_t i = 0; i < S; ++i) tmp[i] = aMask[i] ? aTrue : aFalse[i];
+		return tmp;
+	}
+
+	// Masked arithmetic, lanes not set in the mask keep the value of the first operand
+	#define SOLAIRE_VECTOR_MASKED(aName, aOp)\
+		template<class T, const uint32_t S>\
+		vector<T,S> aName(const vector_mask<S> aMask, const vector<T,S>& aFirst, const vector<T,S>& aSecond) throw() {\
+			vector<T,S> tmp;\
+			for(uint32_t i = 0; i < S; ++i) tmp[i] = aMask[i] ? aFirst[i] aOp aSecond[i] : aFirst[i];\
+			return tmp;\
+		}\
+		template<class T, const uint32_t S>\
+		vector<T,S> aName(const vector_mask<S> aMask, const vector<T,S>& aFirst, const T aSecond) throw() {\
+			vector<T,S> tmp;\
+			for(uint32_t i = 0; i < S; ++i) tmp[i] = aMask[i] ? aFirst[i] aOp aSecond : aFirst[i];\
+			return tmp;\
+		}
+
+	SOLAIRE_VECTOR_MASKED(masked_add, +)
+	SOLAIRE_VECTOR_MASKED(masked_sub, -)
+	SOLAIRE_VECTOR_MASKED(masked_mul, *)
+	SOLAIRE_VECTOR_MASKED(masked_div, /)
+
+	#undef SOLAIRE_VECTOR_MASKED
+
+	template<const precision P, class T, const uint32_t S>
+	void length_all(const vector<T,S>* const aInput, T* const aOutput, const uint32_t aCount) throw() {
+		SOLAIRE_INSTRUMENT(INSTRUMENT_VECTOR_BATCH, aCount);
+		for(uint32_t i = 0; i < aCount; ++i) aOutput[i] = aInput[i].magnitude();
+	}
+
+	template<const precision P, const uint32_t S>
+	void length_all(const vector<float,S>* const aInput, float* const aOutput, const uint32_t aCount) throw() {
+		SOLAIRE_INSTRUMENT(INSTRUMENT_VECTOR_BATCH, aCount);
+		for(uint32_t i = 0; i < aCount; ++i) aOutput[i] = aInput[i].magnitude_sq();
+		solaire_sqrt(aOutput, aOutput, aCount, P);
+	}
+
+	template<const precision P, class T, const uint32_t S>
+	void normalise_all(const vector<T,S>* const aInput, vector<T,S>* const aOutput, const uint32_t aCount) throw() {
+		SOLAIRE_INSTRUMENT(INSTRUMENT_VECTOR_BATCH, aCount);
+		for(uint32_t i = 0; i < aCount; ++i) aOutput[i] = aInput[i].template normalise<P>();
+	}
+
+	template<const precision P, const uint32_t S>
+	void normalise_all(const vector<float,S>* const aInput, vector<float,S>* const aOutput, const uint32_t aCount) throw() {
+		SOLAIRE_INSTRUMENT(INSTRUMENT_VECTOR_BATCH, aCount);
+		enum { BLOCK = 64 };
+		float tmp[BLOCK];
+		for(uint32_t i = 0; i < aCount; i += BLOCK) {
+			const uint32_t count = aCount - i < BLOCK ? aCount - i : static_cast<uint32_t>(BLOCK);
+			for(uint32_t j = 0; j < count; ++j) tmp[j] = aInput[i + j].magnitude_sq();
+			if(P == PRECISION_EXACT) {
+				solaire_sqrt(tmp, tmp, count, P);
+				for(uint32_t j = 0; j < count; ++j) aOutput[i + j] = aInput[i + j] / tmp[j];
+			}else {
+				solaire_rsqrt(tmp, tmp, count, P);
+				for(uint32_t j = 0; j < count; ++j) aOutput[i + j] = aInput[i + j] * tmp[j];
+			}
+		}
+	}
+
+	//! \brief Apply a compile-time swizzle to every vector in an array, aInput and aOutput may be the same array
+	template<const uint32_t... I, class T, const uint32_t S>
+	void swizzle_all(const vector<T,S>* const aInput, vector<T, sizeof...(I)>* const aOutput, const uint32_t aCount) throw() {
+		static_assert(_swizzle_valid<S, I...>::value, "solaire::swizzle_all : Index out of bounds");
+		SOLAIRE_INSTRUMENT(INSTRUMENT_VECTOR_BATCH, aCount);
+		if(sizeof(T) == 1 && S == 4 && sizeof...(I) == 4) {
+			// Channel reordering of 8-bit images, eg. RGBA to BGRA
+			const uint8_t indices[sizeof...(I)] = { static_cast<uint8_t>(I)... };
+			solaire_shuffle_bytes4(reinterpret_cast<const uint8_t*>(aInput), reinterpret_cast<uint8_t*>(aOutput), aCount, indices);
+		}else {
+			for(uint32_t i = 0; i < aCount; ++i) vector_shuffle<T, S, I...>::apply(reinterpret_cast<const T*>(aInput + i), reinterpret_cast<T*>(aOutput + i));
+		}
+	}
+
 	template<class T, const uint32_t S>
 	std::ostream& operator<<(std::ostream& aStream, const vector<T,S>& aVector) {
 		aStream << '[';
@@ -470,6 +765,8 @@ namespace solaire {
 		typedef vector<int64_t, aNum> vector_ ## aNum ## i64;\
 		typedef vector<float, aNum> vector_ ## aNum ## f;\
 		typedef vector<double, aNum> vector_ ## aNum ## d;\
+		typedef vector<half, aNum> vector_ ## aNum ## h;\
+		typedef vector<fixed_16_16, aNum> vector_ ## aNum ## q16;\
 		typedef vector<unsigned int, aNum> vector_ ## aNum ##u;\
 		typedef vector<int, aNum> vector_ ## aNum ##i;
 
@@ -487,6 +784,16 @@ namespace solaire {
 	typedef vector_4u8 vector_rgba;
 
 	#undef SOLAIRE_DEF_VECTORS
+
+	template<class T, const uint32_t S>
+	inline void convert(const vector<T,S>* const aInput, vector<float,S>* const aOutput, const uint32_t aCount) throw() {
+		convert(reinterpret_cast<const T*>(aInput), reinterpret_cast<float*>(aOutput), aCount * S);
+	}
+
+	template<class T, const uint32_t S>
+	inline void convert(const vector<float,S>* const aInput, vector<T,S>* const aOutput, const uint32_t aCount) throw() {
+		convert(reinterpret_cast<const float*>(aInput), reinterpret_cast<T*>(aOutput), aCount * S);
+	}
 }
 
 #define SOLAIRE_VECTORISE_FUNCTION_V(aReturn, aName, aParam)\
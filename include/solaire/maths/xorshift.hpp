@@ -19,33 +19,97 @@
 
 extern "C" SOLAIRE_EXPORT_API uint64_t SOLAIRE_EXPORT_CALL solaire_xorshift_star(uint64_t*);
 extern "C" SOLAIRE_EXPORT_API uint64_t SOLAIRE_EXPORT_CALL solaire_xorshift_plus(uint64_t*);
+extern "C" SOLAIRE_EXPORT_API void SOLAIRE_EXPORT_CALL solaire_xorshift_star_all(uint64_t*, double*, const uint32_t);
+extern "C" SOLAIRE_EXPORT_API void SOLAIRE_EXPORT_CALL solaire_xorshift_plus_all(uint64_t*, double*, const uint32_t);
 
 namespace solaire {
 
 	inline uint64_t xorshift_star(uint64_t& aSeed) {
-		solaire_xorshift_star(&aSeed);
+		return solaire_xorshift_star(&aSeed);
 	}
 
 	inline uint64_t xorshift_plus(uint64_t* const aSeed) {
-		solaire_xorshift_plus(aSeed);
+		return solaire_xorshift_plus(aSeed);
 	}
 
+	//! \brief Map the top 53 bits of a random integer to a double in [0, 1)
+	SOLAIRE_CONSTEXPR_I11 double to_normal(const uint64_t aBits) throw() {
+		return static_cast<double>(aBits >> 11) * (1.0 / 9007199254740992.0);
+	}
+
+	//! \brief splitmix64 step, expands a seed into well mixed xorshift state
+	inline uint64_t splitmix(uint64_t& aSeed) throw() {
+		uint64_t z = (aSeed += 0x9E3779B97F4A7C15ull);
+		z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+		z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+		return z ^ (z >> 31);
+	}
+
+	//! \brief Inline xorshift* generator for kernels that draw one or more values per element
+	//! \detail Produces the same sequence as xorshift_star_randomiser with the same seed
+	class xorshift_engine {
+	private:
+		uint64_t mState;
+	public:
+		explicit xorshift_engine(uint64_t aSeed) throw() :
+			mState(splitmix(aSeed))
+		{
+			if(mState == 0) mState = 1;
+		}
+
+		inline uint64_t next() throw() {
+			mState ^= mState >> 12;
+			mState ^= mState << 25;
+			mState ^= mState >> 27;
+			return mState * 2685821657736338717ull;
+		}
+
+		//! \return An unbiased value in [0, aRange), Lemire's multiply and reject method
+		inline uint32_t next(const uint32_t aRange) throw() {
+			uint64_t m = (next() >> 32) * aRange;
+			uint32_t low = static_cast<uint32_t>(m);
+			if(low < aRange) {
+				const uint32_t threshold = (0u - aRange) % aRange;
+				while(low < threshold) {
+					m = (next() >> 32) * aRange;
+					low = static_cast<uint32_t>(m);
+				}
+			}
+			return static_cast<uint32_t>(m >> 32);
+		}
+
+		//! \return A value in [0, 1)
+		inline double next_normal() throw() {
+			return to_normal(next());
+		}
+
+		//! \return A value in (0, 1), safe to take the logarithm of
+		inline double next_open_normal() throw() {
+			return (static_cast<double>(next() >> 11) + 0.5) * (1.0 / 9007199254740992.0);
+		}
+	};
+
 	SOLAIRE_EXPORT_CLASS xorshift_star_randomiser : public randomiser{
 	private:
 		uint64_t mSeed;
+		uint64_t mState;
 	protected:
 		// inherited from randomiser
 		SOLAIRE_INTERFACE_CALL double random_normal() throw() override {
-			return xorshift_star(mSeed);
+			return to_normal(xorshift_star(mState));
+		}
+
+		void SOLAIRE_INTERFACE_CALL random_normal_all(double* const aOutput, const uint32_t aCount) throw() override {
+			solaire_xorshift_star_all(&mState, aOutput, aCount);
 		}
 	public:
-		xorshift_star_randomiser() :
-			mSeed(rand())
-		{}
+		xorshift_star_randomiser() {
+			set_seed(rand());
+		}
 
-		xorshift_star_randomiser(const uint64_t aSeed) :
-			mSeed(aSeed)
-		{}
+		xorshift_star_randomiser(const uint64_t aSeed) {
+			set_seed(aSeed);
+		}
 
 		// inherited from randomiser
 		uint64_t SOLAIRE_INTERFACE_CALL get_seed() const throw() override {
@@ -54,36 +118,45 @@ namespace solaire {
 
 		void SOLAIRE_INTERFACE_CALL set_seed(const uint64_t aSeed) throw() override {
 			mSeed = aSeed;
+			uint64_t tmp = aSeed;
+			mState = splitmix(tmp);
+			if(mState == 0) mState = 1;
 		}
 	};
 
 	SOLAIRE_EXPORT_CLASS xorshift_plus_randomiser : public randomiser{
 	private:
-		uint64_t mSeed[2];
+		uint64_t mSeed;
+		uint64_t mState[2];
 	protected:
 		// inherited from randomiser
 		SOLAIRE_INTERFACE_CALL double random_normal() throw() override {
-			return xorshift_plus(mSeed);
+			return to_normal(xorshift_plus(mState));
+		}
+
+		void SOLAIRE_INTERFACE_CALL random_normal_all(double* const aOutput, const uint32_t aCount) throw() override {
+			solaire_xorshift_plus_all(mState, aOutput, aCount);
 		}
 	public:
 		xorshift_plus_randomiser() {
-			mSeed[0] = rand();
-			mSeed[1] = ~mSeed[0];
+			set_seed(rand());
 		}
 
 		xorshift_plus_randomiser(const uint64_t aSeed) {
-			mSeed[0] = aSeed;
-			mSeed[1] = ~aSeed;
+			set_seed(aSeed);
 		}
 
 		// inherited from randomiser
 		uint64_t SOLAIRE_INTERFACE_CALL get_seed() const throw() override {
-			return mSeed[0];
+			return mSeed;
 		}
 
 		void SOLAIRE_INTERFACE_CALL set_seed(const uint64_t aSeed) throw() override {
-			mSeed[0] = aSeed;
-			mSeed[1] = ~aSeed;
+			mSeed = aSeed;
+			uint64_t tmp = aSeed;
+			mState[0] = splitmix(tmp);
+			mState[1] = splitmix(tmp);
+			if(mState[0] == 0 && mState[1] == 0) mState[0] = 1;
 		}
 	};
 }
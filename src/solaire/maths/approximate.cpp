@@ -0,0 +1,117 @@
+//Copyright 2016 Adam G. Smith
+//
+//Licensed under the Apache License, Version 2.0 (the "License");
+//you may not use this file except in compliance with the License.
+//You may obtain a copy of the License at
+//
+//http ://www.apache.org/licenses/LICENSE-2.0
+//
+//Unless required by applicable law or agreed to in writing, software
+//distributed under the License is distributed on an "AS IS" BASIS,
+//WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//See the License for the specific language governing permissions and
+//limitations under the License.
+
+#include "solaire/maths/approximate.hpp"
+
+#if defined(SOLAIRE_MATHS_AVX)
+	#include <immintrin.h>
+#endif
+
+#if SOLAIRE_COMPILE_MODE != SOLAIRE_SHARED_IMPORT_COMPILE
+
+extern "C" SOLAIRE_EXPORT_API void SOLAIRE_EXPORT_CALL solaire_rsqrt(const float* aInput, float* aOutput, const uint32_t aCount, const solaire::precision aPrecision) {
+	uint32_t i = 0;
+	if(aPrecision != solaire::PRECISION_EXACT) {
+		#if defined(SOLAIRE_MATHS_AVX)
+			const __m256 half8 = _mm256_set1_ps(0.5f);
+			const __m256 three_halves8 = _mm256_set1_ps(1.5f);
+			for(; i + 8 <= aCount; i += 8) {
+				const __m256 x = _mm256_loadu_ps(aInput + i);
+				__m256 y = _mm256_rsqrt_ps(x);
+				if(aPrecision == solaire::PRECISION_REFINED) {
+					y = _mm256_mul_ps(y, _mm256_sub_ps(three_halves8, _mm256_mul_ps(_mm256_mul_ps(half8, x), _mm256_mul_ps(y, y))));
+				}
+				_mm256_storeu_ps(aOutput + i, y);
+			}
+		#endif
+		#if defined(SOLAIRE_MATHS_SSE2)
+			const __m128 half4 = _mm_set1_ps(0.5f);
+			const __m128 three_halves4 = _mm_set1_ps(1.5f);
+			for(; i + 4 <= aCount; i += 4) {
+				const __m128 x = _mm_loadu_ps(aInput + i);
+				__m128 y = _mm_rsqrt_ps(x);
+				if(aPrecision == solaire::PRECISION_REFINED) {
+					y = _mm_mul_ps(y, _mm_sub_ps(three_halves4, _mm_mul_ps(_mm_mul_ps(half4, x), _mm_mul_ps(y, y))));
+				}
+				_mm_storeu_ps(aOutput + i, y);
+			}
+		#endif
+	}
+
+	switch(aPrecision) {
+	case solaire::PRECISION_REFINED:
+		for(; i < aCount; ++i) aOutput[i] = solaire::rsqrt<solaire::PRECISION_REFINED>(aInput[i]);
+		break;
+	case solaire::PRECISION_ESTIMATE:
+		for(; i < aCount; ++i) aOutput[i] = solaire::rsqrt<solaire::PRECISION_ESTIMATE>(aInput[i]);
+		break;
+	default:
+		for(; i < aCount; ++i) aOutput[i] = 1.f / std::sqrt(aInput[i]);
+		break;
+	}
+}
+
+extern "C" SOLAIRE_EXPORT_API void SOLAIRE_EXPORT_CALL solaire_rcp(const float* aInput, float* aOutput, const uint32_t aCount, const solaire::precision aPrecision) {
+	uint32_t i = 0;
+	if(aPrecision != solaire::PRECISION_EXACT) {
+		#if defined(SOLAIRE_MATHS_AVX)
+			const __m256 two8 = _mm256_set1_ps(2.f);
+			for(; i + 8 <= aCount; i += 8) {
+				const __m256 x = _mm256_loadu_ps(aInput + i);
+				__m256 y = _mm256_rcp_ps(x);
+				if(aPrecision == solaire::PRECISION_REFINED) y = _mm256_mul_ps(y, _mm256_sub_ps(two8, _mm256_mul_ps(x, y)));
+				_mm256_storeu_ps(aOutput + i, y);
+			}
+		#endif
+		#if defined(SOLAIRE_MATHS_SSE2)
+			const __m128 two4 = _mm_set1_ps(2.f);
+			for(; i + 4 <= aCount; i += 4) {
+				const __m128 x = _mm_loadu_ps(aInput + i);
+				__m128 y = _mm_rcp_ps(x);
+				if(aPrecision == solaire::PRECISION_REFINED) y = _mm_mul_ps(y, _mm_sub_ps(two4, _mm_mul_ps(x, y)));
+				_mm_storeu_ps(aOutput + i, y);
+			}
+		#endif
+	}
+
+	switch(aPrecision) {
+	case solaire::PRECISION_REFINED:
+		for(; i < aCount; ++i) aOutput[i] = solaire::rcp<solaire::PRECISION_REFINED>(aInput[i]);
+		break;
+	case solaire::PRECISION_ESTIMATE:
+		for(; i < aCount; ++i) aOutput[i] = solaire::rcp<solaire::PRECISION_ESTIMATE>(aInput[i]);
+		break;
+	default:
+		for(; i < aCount; ++i) aOutput[i] = 1.f / aInput[i];
+		break;
+	}
+}
+
+extern "C" SOLAIRE_EXPORT_API void SOLAIRE_EXPORT_CALL solaire_sqrt(const float* aInput, float* aOutput, const uint32_t aCount, const solaire::precision aPrecision) {
+	if(aPrecision == solaire::PRECISION_EXACT) {
+		for(uint32_t i = 0; i < aCount; ++i) aOutput[i] = std::sqrt(aInput[i]);
+		return;
+	}
+
+	// sqrt(x) = x * rsqrt(x), zero must be special cased as rsqrt(0) is infinity
+	enum { BLOCK = 64 };
+	float tmp[BLOCK];
+	for(uint32_t i = 0; i < aCount; i += BLOCK) {
+		const uint32_t count = aCount - i < BLOCK ? aCount - i : static_cast<uint32_t>(BLOCK);
+		solaire_rsqrt(aInput + i, tmp, count, aPrecision);
+		for(uint32_t j = 0; j < count; ++j) aOutput[i + j] = aInput[i + j] == 0.f ? 0.f : aInput[i + j] * tmp[j];
+	}
+}
+
+#endif
@@ -0,0 +1,24 @@
+//Copyright 2016 Adam G. Smith
+//
+//Licensed under the Apache License, Version 2.0 (the "License");
+//you may not use this file except in compliance with the License.
+//You may obtain a copy of the License at
+//
+//http ://www.apache.org/licenses/LICENSE-2.0
+//
+//Unless required by applicable law or agreed to in writing, software
+//distributed under the License is distributed on an "AS IS" BASIS,
+//WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//See the License for the specific language governing permissions and
+//limitations under the License.
+
+#include "solaire/maths/arena.hpp"
+
+#if SOLAIRE_COMPILE_MODE != SOLAIRE_SHARED_IMPORT_COMPILE
+
+extern "C" SOLAIRE_EXPORT_API solaire::maths_arena* SOLAIRE_EXPORT_CALL solaire_thread_arena() {
+	static thread_local solaire::maths_arena ARENA;
+	return &ARENA;
+}
+
+#endif
@@ -0,0 +1,64 @@
+//Copyright 2016 Adam G. Smith
+//
+//Licensed under the Apache License, Version 2.0 (the "License");
+//you may not use this file except in compliance with the License.
+//You may obtain a copy of the License at
+//
+//http ://www.apache.org/licenses/LICENSE-2.0
+//
+//Unless required by applicable law or agreed to in writing, software
+//distributed under the License is distributed on an "AS IS" BASIS,
+//WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//See the License for the specific language governing permissions and
+//limitations under the License.
+
+
+#include "solaire/maths/fixed.hpp"
+
+#if defined(SOLAIRE_MATHS_AVX)
+	#include <immintrin.h>
+#elif defined(SOLAIRE_MATHS_SSE2)
+	#include <emmintrin.h>
+#endif
+
+#if SOLAIRE_COMPILE_MODE != SOLAIRE_SHARED_IMPORT_COMPILE
+
+extern "C" SOLAIRE_EXPORT_API void SOLAIRE_EXPORT_CALL solaire_fixed32_to_float(const int32_t* aInput, float* aOutput, const uint32_t aCount, const uint32_t aFractionBits) {
+	const float scale = std::ldexp(1.f, -static_cast<int>(aFractionBits));
+	uint32_t i = 0;
+	#if defined(SOLAIRE_MATHS_AVX)
+		const __m256 scale8 = _mm256_set1_ps(scale);
+		for(; i + 8 <= aCount; i += 8) {
+			const __m256i tmp = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(aInput + i));
+			_mm256_storeu_ps(aOutput + i, _mm256_mul_ps(_mm256_cvtepi32_ps(tmp), scale8));
+		}
+	#elif defined(SOLAIRE_MATHS_SSE2)
+		const __m128 scale4 = _mm_set1_ps(scale);
+		for(; i + 4 <= aCount; i += 4) {
+			const __m128i tmp = _mm_loadu_si128(reinterpret_cast<const __m128i*>(aInput + i));
+			_mm_storeu_ps(aOutput + i, _mm_mul_ps(_mm_cvtepi32_ps(tmp), scale4));
+		}
+	#endif
+	for(; i < aCount; ++i) aOutput[i] = static_cast<float>(aInput[i]) * scale;
+}
+
+extern "C" SOLAIRE_EXPORT_API void SOLAIRE_EXPORT_CALL solaire_float_to_fixed32(const float* aInput, int32_t* aOutput, const uint32_t aCount, const uint32_t aFractionBits) {
+	const float scale = std::ldexp(1.f, static_cast<int>(aFractionBits));
+	uint32_t i = 0;
+	#if defined(SOLAIRE_MATHS_AVX)
+		const __m256 scale8 = _mm256_set1_ps(scale);
+		for(; i + 8 <= aCount; i += 8) {
+			const __m256i tmp = _mm256_cvtps_epi32(_mm256_mul_ps(_mm256_loadu_ps(aInput + i), scale8));
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(aOutput + i), tmp);
+		}
+	#elif defined(SOLAIRE_MATHS_SSE2)
+		const __m128 scale4 = _mm_set1_ps(scale);
+		for(; i + 4 <= aCount; i += 4) {
+			const __m128i tmp = _mm_cvtps_epi32(_mm_mul_ps(_mm_loadu_ps(aInput + i), scale4));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(aOutput + i), tmp);
+		}
+	#endif
+	for(; i < aCount; ++i) aOutput[i] = static_cast<int32_t>(std::lrint(aInput[i] * scale));
+}
+
+#endif
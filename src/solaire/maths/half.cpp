@@ -0,0 +1,46 @@
+//Copyright 2016 Adam G. Smith
+//
+//Licensed under the Apache License, Version 2.0 (the "License");
+//you may not use this file except in compliance with the License.
+//You may obtain a copy of the License at
+//
+//http ://www.apache.org/licenses/LICENSE-2.0
+//
+//Unless required by applicable law or agreed to in writing, software
+//distributed under the License is distributed on an "AS IS" BASIS,
+//WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//See the License for the specific language governing permissions and
+//limitations under the License.
+
+
+#include "solaire/maths/half.hpp"
+
+#if defined(SOLAIRE_MATHS_F16C)
+	#include <immintrin.h>
+#endif
+
+#if SOLAIRE_COMPILE_MODE != SOLAIRE_SHARED_IMPORT_COMPILE
+
+extern "C" SOLAIRE_EXPORT_API void SOLAIRE_EXPORT_CALL solaire_half_to_float(const uint16_t* aInput, float* aOutput, const uint32_t aCount) {
+	uint32_t i = 0;
+	#if defined(SOLAIRE_MATHS_F16C)
+		for(; i + 8 <= aCount; i += 8) {
+			const __m128i tmp = _mm_loadu_si128(reinterpret_cast<const __m128i*>(aInput + i));
+			_mm256_storeu_ps(aOutput + i, _mm256_cvtph_ps(tmp));
+		}
+	#endif
+	for(; i < aCount; ++i) aOutput[i] = solaire::half_bits_to_float(aInput[i]);
+}
+
+extern "C" SOLAIRE_EXPORT_API void SOLAIRE_EXPORT_CALL solaire_float_to_half(const float* aInput, uint16_t* aOutput, const uint32_t aCount) {
+	uint32_t i = 0;
+	#if defined(SOLAIRE_MATHS_F16C)
+		for(; i + 8 <= aCount; i += 8) {
+			const __m128i tmp = _mm256_cvtps_ph(_mm256_loadu_ps(aInput + i), _MM_FROUND_TO_NEAREST_INT);
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(aOutput + i), tmp);
+		}
+	#endif
+	for(; i < aCount; ++i) aOutput[i] = solaire::float_to_half_bits(aInput[i]);
+}
+
+#endif
@@ -0,0 +1,54 @@
+//Copyright 2016 Adam G. Smith
+//
+//Licensed under the Apache License, Version 2.0 (the "License");
+//you may not use this file except in compliance with the License.
+//You may obtain a copy of the License at
+//
+//http ://www.apache.org/licenses/LICENSE-2.0
+//
+//Unless required by applicable law or agreed to in writing, software
+//distributed under the License is distributed on an "AS IS" BASIS,
+//WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//See the License for the specific language governing permissions and
+//limitations under the License.
+
+#include "solaire/maths/hash.hpp"
+
+#if defined(SOLAIRE_MATHS_AVX2)
+	#include <immintrin.h>
+#endif
+
+#if SOLAIRE_COMPILE_MODE != SOLAIRE_SHARED_IMPORT_COMPILE
+
+extern "C" SOLAIRE_EXPORT_API void SOLAIRE_EXPORT_CALL solaire_hash_cells(const int32_t* aCells, uint32_t* aHashes, const uint32_t aCount, const uint32_t aDimensions) {
+	uint32_t i = 0;
+	#if defined(SOLAIRE_MATHS_AVX2)
+		// Gather one component of 8 cells per step
+		const __m256i stride = _mm256_mullo_epi32(_mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7), _mm256_set1_epi32(static_cast<int>(aDimensions)));
+		const __m256i multiplier = _mm256_set1_epi32(static_cast<int>(solaire::HASH_MULTIPLIER));
+		const __m256i mix0 = _mm256_set1_epi32(static_cast<int>(0x85EBCA6B));
+		const __m256i mix1 = _mm256_set1_epi32(static_cast<int>(0xC2B2AE35));
+		for(; i + 8 <= aCount; i += 8) {
+			const int32_t* const base = aCells + i * aDimensions;
+			__m256i h = _mm256_set1_epi32(static_cast<int>(solaire::HASH_SEED));
+			for(uint32_t j = 0; j < aDimensions; ++j) {
+				const __m256i component = _mm256_i32gather_epi32(base + j, stride, 4);
+				h = _mm256_mullo_epi32(_mm256_xor_si256(h, component), multiplier);
+			}
+			h = _mm256_xor_si256(h, _mm256_srli_epi32(h, 16));
+			h = _mm256_mullo_epi32(h, mix0);
+			h = _mm256_xor_si256(h, _mm256_srli_epi32(h, 13));
+			h = _mm256_mullo_epi32(h, mix1);
+			h = _mm256_xor_si256(h, _mm256_srli_epi32(h, 16));
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(aHashes + i), h);
+		}
+	#endif
+	for(; i < aCount; ++i) {
+		const int32_t* const cell = aCells + i * aDimensions;
+		uint32_t h = solaire::HASH_SEED;
+		for(uint32_t j = 0; j < aDimensions; ++j) h = (h ^ static_cast<uint32_t>(cell[j])) * solaire::HASH_MULTIPLIER;
+		aHashes[i] = solaire::hash_mix(h);
+	}
+}
+
+#endif
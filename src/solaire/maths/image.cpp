@@ -0,0 +1,357 @@
+//Copyright 2016 Adam G. Smith
+//
+//Licensed under the Apache License, Version 2.0 (the "License");
+//you may not use this file except in compliance with the License.
+//You may obtain a copy of the License at
+//
+//http ://www.apache.org/licenses/LICENSE-2.0
+//
+//Unless required by applicable law or agreed to in writing, software
+//distributed under the License is distributed on an "AS IS" BASIS,
+//WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//See the License for the specific language governing permissions and
+//limitations under the License.
+
+#include "solaire/maths/image.hpp"
+
+#if defined(SOLAIRE_MATHS_SSE2)
+	#include <immintrin.h>
+#endif
+
+#if SOLAIRE_COMPILE_MODE != SOLAIRE_SHARED_IMPORT_COMPILE
+
+namespace {
+	struct srgb_tables {
+		float to_linear[256];
+		uint8_t to_srgb[solaire::IMAGE_SRGB_TABLE + 4];	//!< Padded so 32-bit gathers stay in bounds
+
+		srgb_tables() {
+			for(uint32_t i = 0; i < 256; ++i) to_linear[i] = solaire::srgb_to_linear(static_cast<float>(i) / 255.f);
+			for(uint32_t i = 0; i < solaire::IMAGE_SRGB_TABLE; ++i) {
+				const float value = solaire::linear_to_srgb(static_cast<float>(i) / static_cast<float>(solaire::IMAGE_SRGB_TABLE - 1));
+				to_srgb[i] = static_cast<uint8_t>(value * 255.f + 0.5f);
+			}
+			for(uint32_t i = solaire::IMAGE_SRGB_TABLE; i < solaire::IMAGE_SRGB_TABLE + 4; ++i) to_srgb[i] = 255;
+		}
+	};
+
+	const srgb_tables& get_srgb_tables() {
+		static const srgb_tables TABLES;
+		return TABLES;
+	}
+
+	// Exact rounded division of [0, 65025] by 255, shared by the scalar and SIMD paths
+	inline uint32_t div255(uint32_t aValue) throw() {
+		aValue += 128;
+		return (aValue + (aValue >> 8)) >> 8;
+	}
+
+	inline uint8_t saturate_u8(const float aValue) throw() {
+		return static_cast<uint8_t>(std::nearbyint(aValue > 0.f ? (aValue < 255.f ? aValue : 255.f) : 0.f));
+	}
+
+	#if defined(SOLAIRE_MATHS_SSE2)
+		inline __m128i div255(__m128i aValue) throw() {
+			aValue = _mm_add_epi16(aValue, _mm_set1_epi16(128));
+			return _mm_srli_epi16(_mm_add_epi16(aValue, _mm_srli_epi16(aValue, 8)), 8);
+		}
+
+		inline __m128i broadcast_alpha(const __m128i aValue) throw() {
+			return _mm_shufflehi_epi16(_mm_shufflelo_epi16(aValue, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+		}
+
+		// 2 pixels widened to 16-bit channels
+		inline __m128i blend(const __m128i aSource, const __m128i aDestination, const __m128i aAlpha) throw() {
+			const __m128i inverse = _mm_sub_epi16(_mm_set1_epi16(255), aAlpha);
+			return div255(_mm_add_epi16(_mm_mullo_epi16(aSource, aAlpha), _mm_mullo_epi16(aDestination, inverse)));
+		}
+	#endif
+
+	#if defined(SOLAIRE_MATHS_AVX2)
+		inline __m256i div255(__m256i aValue) throw() {
+			aValue = _mm256_add_epi16(aValue, _mm256_set1_epi16(128));
+			return _mm256_srli_epi16(_mm256_add_epi16(aValue, _mm256_srli_epi16(aValue, 8)), 8);
+		}
+
+		inline __m256i broadcast_alpha(const __m256i aValue) throw() {
+			return _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(aValue, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+		}
+
+		inline __m256i blend(const __m256i aSource, const __m256i aDestination, const __m256i aAlpha) throw() {
+			const __m256i inverse = _mm256_sub_epi16(_mm256_set1_epi16(255), aAlpha);
+			return div255(_mm256_add_epi16(_mm256_mullo_epi16(aSource, aAlpha), _mm256_mullo_epi16(aDestination, inverse)));
+		}
+	#endif
+}
+
+extern "C" SOLAIRE_EXPORT_API void SOLAIRE_EXPORT_CALL solaire_u8_add_saturate(const uint8_t* aFirst, const uint8_t* aSecond, uint8_t* aOutput, const uint32_t aCount) {
+	uint32_t i = 0;
+	#if defined(SOLAIRE_MATHS_AVX2)
+		for(; i + 32 <= aCount; i += 32) {
+			const __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(aFirst + i));
+			const __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(aSecond + i));
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(aOutput + i), _mm256_adds_epu8(a, b));
+		}
+	#endif
+	#if defined(SOLAIRE_MATHS_SSE2)
+		for(; i + 16 <= aCount; i += 16) {
+			const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(aFirst + i));
+			const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(aSecond + i));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(aOutput + i), _mm_adds_epu8(a, b));
+		}
+	#endif
+	for(; i < aCount; ++i) {
+		const uint32_t tmp = static_cast<uint32_t>(aFirst[i]) + aSecond[i];
+		aOutput[i] = static_cast<uint8_t>(tmp > 255 ? 255 : tmp);
+	}
+}
+
+extern "C" SOLAIRE_EXPORT_API void SOLAIRE_EXPORT_CALL solaire_u8_sub_saturate(const uint8_t* aFirst, const uint8_t* aSecond, uint8_t* aOutput, const uint32_t aCount) {
+	uint32_t i = 0;
+	#if defined(SOLAIRE_MATHS_AVX2)
+		for(; i + 32 <= aCount; i += 32) {
+			const __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(aFirst + i));
+			const __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(aSecond + i));
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(aOutput + i), _mm256_subs_epu8(a, b));
+		}
+	#endif
+	#if defined(SOLAIRE_MATHS_SSE2)
+		for(; i + 16 <= aCount; i += 16) {
+			const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(aFirst + i));
+			const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(aSecond + i));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(aOutput + i), _mm_subs_epu8(a, b));
+		}
+	#endif
+	for(; i < aCount; ++i) aOutput[i] = static_cast<uint8_t>(aFirst[i] > aSecond[i] ? aFirst[i] - aSecond[i] : 0);
+}
+
+extern "C" SOLAIRE_EXPORT_API void SOLAIRE_EXPORT_CALL solaire_u8_to_float(const uint8_t* aInput, float* aOutput, const uint32_t aCount, const float aScale) {
+	uint32_t i = 0;
+	#if defined(SOLAIRE_MATHS_AVX2)
+		const __m256 scale8 = _mm256_set1_ps(aScale);
+		for(; i + 8 <= aCount; i += 8) {
+			const __m256i tmp = _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(aInput + i)));
+			_mm256_storeu_ps(aOutput + i, _mm256_mul_ps(_mm256_cvtepi32_ps(tmp), scale8));
+		}
+	#elif defined(SOLAIRE_MATHS_SSE2)
+		const __m128 scale4 = _mm_set1_ps(aScale);
+		const __m128i zero = _mm_setzero_si128();
+		for(; i + 8 <= aCount; i += 8) {
+			const __m128i tmp = _mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(aInput + i)), zero);
+			_mm_storeu_ps(aOutput + i, _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi16(tmp, zero)), scale4));
+			_mm_storeu_ps(aOutput + i + 4, _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpackhi_epi16(tmp, zero)), scale4));
+		}
+	#endif
+	for(; i < aCount; ++i) aOutput[i] = static_cast<float>(aInput[i]) * aScale;
+}
+
+extern "C" SOLAIRE_EXPORT_API void SOLAIRE_EXPORT_CALL solaire_float_to_u8(const float* aInput, uint8_t* aOutput, const uint32_t aCount, const float aScale) {
+	uint32_t i = 0;
+	#if defined(SOLAIRE_MATHS_SSE2)
+		// Clamping first keeps NaN and out of range values away from the integer conversion
+		const __m128 scale4 = _mm_set1_ps(aScale);
+		const __m128 zero = _mm_setzero_ps();
+		const __m128 max = _mm_set1_ps(255.f);
+		for(; i + 16 <= aCount; i += 16) {
+			__m128i tmp[4];
+			for(uint32_t j = 0; j < 4; ++j) {
+				const __m128 value = _mm_mul_ps(_mm_loadu_ps(aInput + i + j * 4), scale4);
+				tmp[j] = _mm_cvtps_epi32(_mm_min_ps(_mm_max_ps(value, zero), max));
+			}
+			const __m128i packed = _mm_packus_epi16(_mm_packs_epi32(tmp[0], tmp[1]), _mm_packs_epi32(tmp[2], tmp[3]));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(aOutput + i), packed);
+		}
+	#endif
+	for(; i < aCount; ++i) aOutput[i] = saturate_u8(aInput[i] * aScale);
+}
+
+extern "C" SOLAIRE_EXPORT_API void SOLAIRE_EXPORT_CALL solaire_rgba_blend(const uint8_t* aSource, const uint8_t* aDestination, uint8_t* aOutput, const uint32_t aCount) {
+	// Treating the source alpha channel as 255 gives a = src.a + dst.a * (255 - src.a) / 255 from the colour formula
+	uint32_t i = 0;
+	#if defined(SOLAIRE_MATHS_AVX2)
+		const __m256i opaque8 = _mm256_set1_epi32(static_cast<int>(0xFF000000));
+		const __m256i zero8 = _mm256_setzero_si256();
+		for(; i + 8 <= aCount; i += 8) {
+			const __m256i s = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(aSource + i * 4));
+			const __m256i d = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(aDestination + i * 4));
+			const __m256i so = _mm256_or_si256(s, opaque8);
+			const __m256i lo = blend(_mm256_unpacklo_epi8(so, zero8), _mm256_unpacklo_epi8(d, zero8), broadcast_alpha(_mm256_unpacklo_epi8(s, zero8)));
+			const __m256i hi = blend(_mm256_unpackhi_epi8(so, zero8), _mm256_unpackhi_epi8(d, zero8), broadcast_alpha(_mm256_unpackhi_epi8(s, zero8)));
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(aOutput + i * 4), _mm256_packus_epi16(lo, hi));
+		}
+	#endif
+	#if defined(SOLAIRE_MATHS_SSE2)
+		const __m128i opaque = _mm_set1_epi32(static_cast<int>(0xFF000000));
+		const __m128i zero = _mm_setzero_si128();
+		for(; i + 4 <= aCount; i += 4) {
+			const __m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i*>(aSource + i * 4));
+			const __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i*>(aDestination + i * 4));
+			const __m128i so = _mm_or_si128(s, opaque);
+			const __m128i lo = blend(_mm_unpacklo_epi8(so, zero), _mm_unpacklo_epi8(d, zero), broadcast_alpha(_mm_unpacklo_epi8(s, zero)));
+			const __m128i hi = blend(_mm_unpackhi_epi8(so, zero), _mm_unpackhi_epi8(d, zero), broadcast_alpha(_mm_unpackhi_epi8(s, zero)));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(aOutput + i * 4), _mm_packus_epi16(lo, hi));
+		}
+	#endif
+	for(; i < aCount; ++i) {
+		const uint8_t* const s = aSource + i * 4;
+		const uint8_t* const d = aDestination + i * 4;
+		uint8_t* const o = aOutput + i * 4;
+		const uint32_t a = s[3];
+		const uint32_t inverse = 255 - a;
+		for(uint32_t j = 0; j < 3; ++j) o[j] = static_cast<uint8_t>(div255(s[j] * a + d[j] * inverse));
+		o[3] = static_cast<uint8_t>(div255(255 * a + d[3] * inverse));
+	}
+}
+
+extern "C" SOLAIRE_EXPORT_API void SOLAIRE_EXPORT_CALL solaire_rgba_blend_premultiplied(const uint8_t* aSource, const uint8_t* aDestination, uint8_t* aOutput, const uint32_t aCount) {
+	uint32_t i = 0;
+	#if defined(SOLAIRE_MATHS_AVX2)
+		const __m256i max8 = _mm256_set1_epi16(255);
+		const __m256i zero8 = _mm256_setzero_si256();
+		for(; i + 8 <= aCount; i += 8) {
+			const __m256i s = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(aSource + i * 4));
+			const __m256i d = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(aDestination + i * 4));
+			const __m256i lo = div255(_mm256_mullo_epi16(_mm256_unpacklo_epi8(d, zero8), _mm256_sub_epi16(max8, broadcast_alpha(_mm256_unpacklo_epi8(s, zero8)))));
+			const __m256i hi = div255(_mm256_mullo_epi16(_mm256_unpackhi_epi8(d, zero8), _mm256_sub_epi16(max8, broadcast_alpha(_mm256_unpackhi_epi8(s, zero8)))));
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(aOutput + i * 4), _mm256_adds_epu8(s, _mm256_packus_epi16(lo, hi)));
+		}
+	#endif
+	#if defined(SOLAIRE_MATHS_SSE2)
+		const __m128i max = _mm_set1_epi16(255);
+		const __m128i zero = _mm_setzero_si128();
+		for(; i + 4 <= aCount; i += 4) {
+			const __m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i*>(aSource + i * 4));
+			const __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i*>(aDestination + i * 4));
+			const __m128i lo = div255(_mm_mullo_epi16(_mm_unpacklo_epi8(d, zero), _mm_sub_epi16(max, broadcast_alpha(_mm_unpacklo_epi8(s, zero)))));
+			const __m128i hi = div255(_mm_mullo_epi16(_mm_unpackhi_epi8(d, zero), _mm_sub_epi16(max, broadcast_alpha(_mm_unpackhi_epi8(s, zero)))));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(aOutput + i * 4), _mm_adds_epu8(s, _mm_packus_epi16(lo, hi)));
+		}
+	#endif
+	for(; i < aCount; ++i) {
+		const uint8_t* const s = aSource + i * 4;
+		const uint8_t* const d = aDestination + i * 4;
+		uint8_t* const o = aOutput + i * 4;
+		const uint32_t inverse = 255 - s[3];
+		for(uint32_t j = 0; j < 4; ++j) {
+			const uint32_t tmp = s[j] + div255(d[j] * inverse);
+			o[j] = static_cast<uint8_t>(tmp > 255 ? 255 : tmp);
+		}
+	}
+}
+
+extern "C" SOLAIRE_EXPORT_API void SOLAIRE_EXPORT_CALL solaire_rgba_premultiply(const uint8_t* aInput, uint8_t* aOutput, const uint32_t aCount) {
+	// The alpha channel is multiplied by 255 so it passes through unchanged
+	uint32_t i = 0;
+	#if defined(SOLAIRE_MATHS_AVX2)
+		const __m256i keep8 = _mm256_setr_epi16(0, 0, 0, 255, 0, 0, 0, 255, 0, 0, 0, 255, 0, 0, 0, 255);
+		const __m256i colour8 = _mm256_setr_epi16(-1, -1, -1, 0, -1, -1, -1, 0, -1, -1, -1, 0, -1, -1, -1, 0);
+		const __m256i zero8 = _mm256_setzero_si256();
+		for(; i + 8 <= aCount; i += 8) {
+			const __m256i p = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(aInput + i * 4));
+			const __m256i pl = _mm256_unpacklo_epi8(p, zero8);
+			const __m256i ph = _mm256_unpackhi_epi8(p, zero8);
+			const __m256i al = _mm256_or_si256(_mm256_and_si256(broadcast_alpha(pl), colour8), keep8);
+			const __m256i ah = _mm256_or_si256(_mm256_and_si256(broadcast_alpha(ph), colour8), keep8);
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(aOutput + i * 4), _mm256_packus_epi16(div255(_mm256_mullo_epi16(pl, al)), div255(_mm256_mullo_epi16(ph, ah))));
+		}
+	#endif
+	#if defined(SOLAIRE_MATHS_SSE2)
+		const __m128i keep = _mm_setr_epi16(0, 0, 0, 255, 0, 0, 0, 255);
+		const __m128i colour = _mm_setr_epi16(-1, -1, -1, 0, -1, -1, -1, 0);
+		const __m128i zero = _mm_setzero_si128();
+		for(; i + 4 <= aCount; i += 4) {
+			const __m128i p = _mm_loadu_si128(reinterpret_cast<const __m128i*>(aInput + i * 4));
+			const __m128i pl = _mm_unpacklo_epi8(p, zero);
+			const __m128i ph = _mm_unpackhi_epi8(p, zero);
+			const __m128i al = _mm_or_si128(_mm_and_si128(broadcast_alpha(pl), colour), keep);
+			const __m128i ah = _mm_or_si128(_mm_and_si128(broadcast_alpha(ph), colour), keep);
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(aOutput + i * 4), _mm_packus_epi16(div255(_mm_mullo_epi16(pl, al)), div255(_mm_mullo_epi16(ph, ah))));
+		}
+	#endif
+	for(; i < aCount; ++i) {
+		const uint8_t* const p = aInput + i * 4;
+		uint8_t* const o = aOutput + i * 4;
+		const uint32_t a = p[3];
+		for(uint32_t j = 0; j < 3; ++j) o[j] = static_cast<uint8_t>(div255(p[j] * a));
+		o[3] = static_cast<uint8_t>(a);
+	}
+}
+
+extern "C" SOLAIRE_EXPORT_API void SOLAIRE_EXPORT_CALL solaire_rgb_to_rgba(const uint8_t* aInput, uint8_t* aOutput, const uint32_t aCount, const uint8_t aAlpha) {
+	uint32_t i = 0;
+	#if defined(SOLAIRE_MATHS_SSSE3)
+		// 4 pixels per step, the 16 byte load reads 4 bytes past them so 2 pixels must follow
+		const __m128i mask = _mm_setr_epi8(0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1);
+		const __m128i alpha = _mm_set1_epi32(static_cast<int>(static_cast<uint32_t>(aAlpha) << 24));
+		for(; i + 6 <= aCount; i += 4) {
+			const __m128i tmp = _mm_loadu_si128(reinterpret_cast<const __m128i*>(aInput + i * 3));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(aOutput + i * 4), _mm_or_si128(_mm_shuffle_epi8(tmp, mask), alpha));
+		}
+	#endif
+	for(; i < aCount; ++i) {
+		aOutput[i * 4] = aInput[i * 3];
+		aOutput[i * 4 + 1] = aInput[i * 3 + 1];
+		aOutput[i * 4 + 2] = aInput[i * 3 + 2];
+		aOutput[i * 4 + 3] = aAlpha;
+	}
+}
+
+extern "C" SOLAIRE_EXPORT_API void SOLAIRE_EXPORT_CALL solaire_rgba_to_rgb(const uint8_t* aInput, uint8_t* aOutput, const uint32_t aCount) {
+	uint32_t i = 0;
+	#if defined(SOLAIRE_MATHS_SSSE3)
+		// 4 pixels per step, the 16 byte store writes 4 bytes past them so 2 pixels must follow
+		const __m128i mask = _mm_setr_epi8(0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1);
+		for(; i + 6 <= aCount; i += 4) {
+			const __m128i tmp = _mm_loadu_si128(reinterpret_cast<const __m128i*>(aInput + i * 4));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(aOutput + i * 3), _mm_shuffle_epi8(tmp, mask));
+		}
+	#endif
+	for(; i < aCount; ++i) {
+		aOutput[i * 3] = aInput[i * 4];
+		aOutput[i * 3 + 1] = aInput[i * 4 + 1];
+		aOutput[i * 3 + 2] = aInput[i * 4 + 2];
+	}
+}
+
+extern "C" SOLAIRE_EXPORT_API void SOLAIRE_EXPORT_CALL solaire_srgb_to_linear(const uint8_t* aInput, float* aOutput, const uint32_t aCount) {
+	const float* const table = get_srgb_tables().to_linear;
+	uint32_t i = 0;
+	#if defined(SOLAIRE_MATHS_AVX2)
+		for(; i + 8 <= aCount; i += 8) {
+			const __m256i index = _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(aInput + i)));
+			_mm256_storeu_ps(aOutput + i, _mm256_i32gather_ps(table, index, 4));
+		}
+	#endif
+	for(; i < aCount; ++i) aOutput[i] = table[aInput[i]];
+}
+
+extern "C" SOLAIRE_EXPORT_API void SOLAIRE_EXPORT_CALL solaire_linear_to_srgb(const float* aInput, uint8_t* aOutput, const uint32_t aCount) {
+	const uint8_t* const table = get_srgb_tables().to_srgb;
+	const float scale = static_cast<float>(solaire::IMAGE_SRGB_TABLE - 1);
+	uint32_t i = 0;
+	#if defined(SOLAIRE_MATHS_AVX2)
+		const __m256 zero8 = _mm256_setzero_ps();
+		const __m256 one8 = _mm256_set1_ps(1.f);
+		const __m256 scale8 = _mm256_set1_ps(scale);
+		const __m256 half8 = _mm256_set1_ps(0.5f);
+		const __m256i byte8 = _mm256_set1_epi32(0xFF);
+		for(; i + 16 <= aCount; i += 16) {
+			__m128i tmp[4];
+			for(uint32_t j = 0; j < 2; ++j) {
+				const __m256 value = _mm256_min_ps(_mm256_max_ps(_mm256_loadu_ps(aInput + i + j * 8), zero8), one8);
+				const __m256i index = _mm256_cvttps_epi32(_mm256_add_ps(_mm256_mul_ps(value, scale8), half8));
+				const __m256i srgb = _mm256_and_si256(_mm256_i32gather_epi32(reinterpret_cast<const int*>(table), index, 1), byte8);
+				tmp[j * 2] = _mm256_castsi256_si128(srgb);
+				tmp[j * 2 + 1] = _mm256_extracti128_si256(srgb, 1);
+			}
+			const __m128i packed = _mm_packus_epi16(_mm_packs_epi32(tmp[0], tmp[1]), _mm_packs_epi32(tmp[2], tmp[3]));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(aOutput + i), packed);
+		}
+	#endif
+	for(; i < aCount; ++i) {
+		const float value = aInput[i] > 0.f ? (aInput[i] < 1.f ? aInput[i] : 1.f) : 0.f;
+		aOutput[i] = table[static_cast<uint32_t>(value * scale + 0.5f)];
+	}
+}
+
+#endif
@@ -0,0 +1,211 @@
+//Copyright 2016 Adam G. Smith
+//
+//Licensed under the Apache License, Version 2.0 (the "License");
+//you may not use this file except in compliance with the License.
+//You may obtain a copy of the License at
+//
+//http ://www.apache.org/licenses/LICENSE-2.0
+//
+//Unless required by applicable law or agreed to in writing, software
+//distributed under the License is distributed on an "AS IS" BASIS,
+//WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//See the License for the specific language governing permissions and
+//limitations under the License.
+
+#include <atomic>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include "solaire/maths/instrument.hpp"
+
+#if SOLAIRE_COMPILE_MODE != SOLAIRE_SHARED_IMPORT_COMPILE
+
+namespace {
+	struct trace_event {
+		uint64_t begin;
+		uint64_t end;
+		uint64_t elements;
+		solaire::instrument_counter counter;
+	};
+
+	// Counters are only added to by their owning thread, atomics make snapshots and resets from other threads safe
+	struct thread_record {
+		std::atomic<uint64_t> calls[solaire::INSTRUMENT_COUNTER_COUNT];
+		std::atomic<uint64_t> elements[solaire::INSTRUMENT_COUNTER_COUNT];
+		std::atomic<uint64_t> cycles[solaire::INSTRUMENT_COUNTER_COUNT];
+		std::vector<trace_event> trace;
+		std::mutex traceLock;
+		uint32_t thread;
+
+		thread_record(const uint32_t aThread) :
+			thread(aThread)
+		{
+			for(uint32_t i = 0; i < solaire::INSTRUMENT_COUNTER_COUNT; ++i) {
+				calls[i].store(0, std::memory_order_relaxed);
+				elements[i].store(0, std::memory_order_relaxed);
+				cycles[i].store(0, std::memory_order_relaxed);
+			}
+		}
+	};
+
+	struct registry {
+		std::mutex lock;
+		std::vector<thread_record*> threads;
+		solaire::instrument_totals retired[solaire::INSTRUMENT_COUNTER_COUNT];
+		std::vector<std::pair<uint32_t, trace_event>> retiredTrace;
+		uint32_t nextThread;
+		std::atomic<bool> trace;
+
+		registry() :
+			nextThread(0)
+		{
+			for(uint32_t i = 0; i < solaire::INSTRUMENT_COUNTER_COUNT; ++i) retired[i] = {0, 0, 0};
+			trace.store(false);
+		}
+	};
+
+	registry& get_registry() {
+		static registry REGISTRY;
+		return REGISTRY;
+	}
+
+	// Registers the calling thread on first use, folds its counters into the retired totals on exit
+	struct thread_handle {
+		std::unique_ptr<thread_record> record;
+
+		thread_handle() {
+			registry& r = get_registry();
+			std::lock_guard<std::mutex> lock(r.lock);
+			record.reset(new thread_record(r.nextThread++));
+			r.threads.push_back(record.get());
+		}
+
+		~thread_handle() {
+			registry& r = get_registry();
+			std::lock_guard<std::mutex> lock(r.lock);
+			for(uint32_t i = 0; i < solaire::INSTRUMENT_COUNTER_COUNT; ++i) {
+				r.retired[i].calls += record->calls[i].load(std::memory_order_relaxed);
+				r.retired[i].elements += record->elements[i].load(std::memory_order_relaxed);
+				r.retired[i].cycles += record->cycles[i].load(std::memory_order_relaxed);
+			}
+			{
+				std::lock_guard<std::mutex> traceLock(record->traceLock);
+				for(const trace_event& i : record->trace) {
+					if(r.retiredTrace.size() >= solaire::INSTRUMENT_TRACE_CAPACITY) break;
+					r.retiredTrace.push_back(std::make_pair(record->thread, i));
+				}
+			}
+			for(size_t i = 0; i < r.threads.size(); ++i) {
+				if(r.threads[i] == record.get()) {
+					r.threads.erase(r.threads.begin() + i);
+					break;
+				}
+			}
+		}
+	};
+
+	thread_record& get_thread_record() {
+		static thread_local thread_handle HANDLE;
+		return *HANDLE.record;
+	}
+
+	// fetch_add rather than load and store, a reset from another thread between the two would otherwise be lost
+	inline void add(std::atomic<uint64_t>& aCounter, const uint64_t aValue) {
+		aCounter.fetch_add(aValue, std::memory_order_relaxed);
+	}
+}
+
+extern "C" SOLAIRE_EXPORT_API void SOLAIRE_EXPORT_CALL solaire_instrument_record(const solaire::instrument_counter aCounter, const uint64_t aElements, const uint64_t aCycles, const uint64_t aBegin, const uint64_t aEnd) {
+	if(aCounter >= solaire::INSTRUMENT_COUNTER_COUNT) return;
+	thread_record& record = get_thread_record();
+	add(record.calls[aCounter], 1);
+	add(record.elements[aCounter], aElements);
+	add(record.cycles[aCounter], aCycles);
+
+	if(get_registry().trace.load(std::memory_order_relaxed)) {
+		std::lock_guard<std::mutex> lock(record.traceLock);
+		if(record.trace.size() < solaire::INSTRUMENT_TRACE_CAPACITY) {
+			trace_event tmp;
+			tmp.begin = aBegin;
+			tmp.end = aEnd;
+			tmp.elements = aElements;
+			tmp.counter = aCounter;
+			record.trace.push_back(tmp);
+		}
+	}
+}
+
+extern "C" SOLAIRE_EXPORT_API uint32_t SOLAIRE_EXPORT_CALL solaire_instrument_snapshot(solaire::instrument_snapshot* aOutput, const uint32_t aCapacity) {
+	registry& r = get_registry();
+	std::lock_guard<std::mutex> lock(r.lock);
+	const uint32_t count = static_cast<uint32_t>(r.threads.size()) + 1;
+	if(aOutput == nullptr) return count;
+
+	uint32_t written = 0;
+	for(const thread_record* i : r.threads) {
+		if(written == aCapacity) return written;
+		solaire::instrument_snapshot& s = aOutput[written++];
+		s.thread = i->thread;
+		for(uint32_t j = 0; j < solaire::INSTRUMENT_COUNTER_COUNT; ++j) {
+			s.counters[j].calls = i->calls[j].load(std::memory_order_relaxed);
+			s.counters[j].elements = i->elements[j].load(std::memory_order_relaxed);
+			s.counters[j].cycles = i->cycles[j].load(std::memory_order_relaxed);
+		}
+	}
+	if(written == aCapacity) return written;
+	solaire::instrument_snapshot& s = aOutput[written++];
+	s.thread = solaire::INSTRUMENT_RETIRED;
+	for(uint32_t j = 0; j < solaire::INSTRUMENT_COUNTER_COUNT; ++j) s.counters[j] = r.retired[j];
+	return written;
+}
+
+extern "C" SOLAIRE_EXPORT_API void SOLAIRE_EXPORT_CALL solaire_instrument_reset() {
+	registry& r = get_registry();
+	std::lock_guard<std::mutex> lock(r.lock);
+	for(thread_record* i : r.threads) {
+		for(uint32_t j = 0; j < solaire::INSTRUMENT_COUNTER_COUNT; ++j) {
+			i->calls[j].store(0, std::memory_order_relaxed);
+			i->elements[j].store(0, std::memory_order_relaxed);
+			i->cycles[j].store(0, std::memory_order_relaxed);
+		}
+		std::lock_guard<std::mutex> traceLock(i->traceLock);
+		i->trace.clear();
+	}
+	for(uint32_t j = 0; j < solaire::INSTRUMENT_COUNTER_COUNT; ++j) r.retired[j] = {0, 0, 0};
+	r.retiredTrace.clear();
+}
+
+extern "C" SOLAIRE_EXPORT_API void SOLAIRE_EXPORT_CALL solaire_instrument_set_trace(const bool aEnabled) {
+	get_registry().trace.store(aEnabled);
+}
+
+static void write_event(FILE* const aFile, bool& aFirst, const uint32_t aThread, const trace_event& aEvent) {
+	std::fprintf(aFile, "%s\n{\"name\":\"%s\",\"cat\":\"solaire\",\"ph\":\"X\",\"pid\":0,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f,\"args\":{\"elements\":%llu}}",
+		aFirst ? "" : ",",
+		solaire::instrument_name(aEvent.counter),
+		aThread,
+		static_cast<double>(aEvent.begin) / 1000.0,
+		static_cast<double>(aEvent.end - aEvent.begin) / 1000.0,
+		static_cast<unsigned long long>(aEvent.elements)
+	);
+	aFirst = false;
+}
+
+extern "C" SOLAIRE_EXPORT_API bool SOLAIRE_EXPORT_CALL solaire_instrument_write_trace(const char* aPath) {
+	FILE* const file = std::fopen(aPath, "w");
+	if(! file) return false;
+
+	registry& r = get_registry();
+	std::lock_guard<std::mutex> lock(r.lock);
+	bool first = true;
+	std::fputs("{\"traceEvents\":[", file);
+	for(const std::pair<uint32_t, trace_event>& i : r.retiredTrace) write_event(file, first, i.first, i.second);
+	for(thread_record* i : r.threads) {
+		std::lock_guard<std::mutex> traceLock(i->traceLock);
+		for(const trace_event& j : i->trace) write_event(file, first, i->thread, j);
+	}
+	std::fputs("\n],\"displayTimeUnit\":\"ns\"}\n", file);
+	return std::fclose(file) == 0;
+}
+
+#endif
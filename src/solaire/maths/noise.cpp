@@ -0,0 +1,138 @@
+//Copyright 2016 Adam G. Smith
+//
+//Licensed under the Apache License, Version 2.0 (the "License");
+//you may not use this file except in compliance with the License.
+//You may obtain a copy of the License at
+//
+//http ://www.apache.org/licenses/LICENSE-2.0
+//
+//Unless required by applicable law or agreed to in writing, software
+//distributed under the License is distributed on an "AS IS" BASIS,
+//WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//See the License for the specific language governing permissions and
+//limitations under the License.
+
+#include "solaire/maths/noise.hpp"
+
+#if defined(SOLAIRE_MATHS_AVX2)
+	#include <immintrin.h>
+#endif
+
+#if SOLAIRE_COMPILE_MODE != SOLAIRE_SHARED_IMPORT_COMPILE
+
+#if defined(SOLAIRE_MATHS_AVX2)
+	static inline __m256i _noise_mix_avx2(__m256i aValue) {
+		aValue = _mm256_xor_si256(aValue, _mm256_slli_epi32(aValue, 13));
+		aValue = _mm256_xor_si256(aValue, _mm256_srli_epi32(aValue, 17));
+		aValue = _mm256_xor_si256(aValue, _mm256_slli_epi32(aValue, 5));
+		return _mm256_mullo_epi32(aValue, _mm256_set1_epi32(0x2545F491));
+	}
+
+	// Same fused / unfused choice as solaire::_noise_madd
+	static inline __m256 _noise_madd_avx2(const __m256 aFirst, const __m256 aSecond, const __m256 aAdd) {
+		#if defined(SOLAIRE_MATHS_FMA)
+			return _mm256_fmadd_ps(aFirst, aSecond, aAdd);
+		#else
+			return _mm256_add_ps(_mm256_mul_ps(aFirst, aSecond), aAdd);
+		#endif
+	}
+
+	static inline __m256 _noise_fade_avx2(const __m256 aValue) {
+		const __m256 inner = _noise_madd_avx2(aValue, _noise_madd_avx2(aValue, _mm256_set1_ps(6.f), _mm256_set1_ps(-15.f)), _mm256_set1_ps(10.f));
+		return _mm256_mul_ps(_mm256_mul_ps(_mm256_mul_ps(aValue, aValue), aValue), inner);
+	}
+
+	//! \brief 8 points per step for value and gradient noise, returns the number of points processed
+	template<const uint32_t D, const bool GRADIENT>
+	static uint32_t _noise_lattice_avx2(const float* const* aComponents, float* aOutput, const uint32_t aCount, const uint32_t aSeed, const float aFrequency, const float aAmplitude) {
+		const __m256 frequency = _mm256_set1_ps(aFrequency);
+		const __m256 amplitude = _mm256_set1_ps(aAmplitude);
+		const __m256 one = _mm256_set1_ps(1.f);
+		const __m256 minusOne = _mm256_set1_ps(-1.f);
+		const __m256 gradientScale = _mm256_set1_ps(static_cast<float>(1.0 / 127.5));
+		const __m256 valueScale = _mm256_set1_ps(static_cast<float>(1.0 / 8388608.0));
+		const __m256 scale = _mm256_set1_ps(solaire::_noise_scale<float>(solaire::NOISE_GRADIENT, D));
+		const __m256i byte = _mm256_set1_epi32(0xFF);
+		const __m256i seed = _mm256_set1_epi32(static_cast<int>(aSeed * 0x9E3779B1));
+
+		uint32_t i = 0;
+		for(; i + 8 <= aCount; i += 8) {
+			__m256i lower[D];
+			__m256i upper[D];
+			__m256 offset[D];
+			__m256 weight[D];
+			for(uint32_t d = 0; d < D; ++d) {
+				const __m256 p = _mm256_mul_ps(_mm256_loadu_ps(aComponents[d] + i), frequency);
+				const __m256 base = _mm256_floor_ps(p);
+				const __m256i prime = _mm256_set1_epi32(static_cast<int>(solaire::noise_prime(d)));
+				lower[d] = _mm256_mullo_epi32(_mm256_cvttps_epi32(base), prime);
+				upper[d] = _mm256_add_epi32(lower[d], prime);
+				offset[d] = _mm256_sub_ps(p, base);
+				weight[d] = _noise_fade_avx2(offset[d]);
+			}
+
+			__m256 result = _mm256_setzero_ps();
+			for(uint32_t c = 0; c < (1u << D); ++c) {
+				__m256i h = seed;
+				__m256 w = one;
+				for(uint32_t d = 0; d < D; ++d) {
+					const bool bit = ((c >> d) & 1) != 0;
+					h = _mm256_xor_si256(h, bit ? upper[d] : lower[d]);
+					w = _mm256_mul_ps(w, bit ? weight[d] : _mm256_sub_ps(one, weight[d]));
+				}
+				h = _noise_mix_avx2(h);
+
+				__m256 v;
+				if(GRADIENT) {
+					v = _mm256_setzero_ps();
+					for(uint32_t d = 0; d < D; ++d) {
+						const __m256 g = _noise_madd_avx2(_mm256_cvtepi32_ps(_mm256_and_si256(_mm256_srli_epi32(h, d * 8), byte)), gradientScale, minusOne);
+						const __m256 o = ((c >> d) & 1) ? _mm256_sub_ps(offset[d], one) : offset[d];
+						v = _noise_madd_avx2(g, o, v);
+					}
+				}else {
+					v = _noise_madd_avx2(_mm256_cvtepi32_ps(_mm256_srli_epi32(h, 8)), valueScale, minusOne);
+				}
+				result = _noise_madd_avx2(w, v, result);
+			}
+			if(GRADIENT) result = _mm256_mul_ps(result, scale);
+			_mm256_storeu_ps(aOutput + i, _noise_madd_avx2(result, amplitude, _mm256_loadu_ps(aOutput + i)));
+		}
+		return i;
+	}
+#endif
+
+extern "C" SOLAIRE_EXPORT_API void SOLAIRE_EXPORT_CALL solaire_noise(const solaire::noise_type aType, const float* const* aComponents, float* aOutput, const uint32_t aCount, const uint32_t aDimensions, const uint32_t aSeed, const float aFrequency, const float aAmplitude) {
+	uint32_t i = 0;
+	#if defined(SOLAIRE_MATHS_AVX2)
+		if(aType == solaire::NOISE_GRADIENT) {
+			if(aDimensions == 2) i = _noise_lattice_avx2<2, true>(aComponents, aOutput, aCount, aSeed, aFrequency, aAmplitude);
+			else if(aDimensions == 3) i = _noise_lattice_avx2<3, true>(aComponents, aOutput, aCount, aSeed, aFrequency, aAmplitude);
+		}else if(aType == solaire::NOISE_VALUE) {
+			if(aDimensions == 2) i = _noise_lattice_avx2<2, false>(aComponents, aOutput, aCount, aSeed, aFrequency, aAmplitude);
+			else if(aDimensions == 3) i = _noise_lattice_avx2<3, false>(aComponents, aOutput, aCount, aSeed, aFrequency, aAmplitude);
+		}
+	#endif
+	if(i == aCount) return;
+
+	const float* components[4];
+	for(uint32_t j = 0; j < aDimensions && j < 4; ++j) components[j] = aComponents[j] + i;
+	switch(aDimensions) {
+	case 1:
+		solaire::_noise_accumulate<1>(aType, components, aOutput + i, aCount - i, aSeed, aFrequency, aAmplitude);
+		break;
+	case 2:
+		solaire::_noise_accumulate<2>(aType, components, aOutput + i, aCount - i, aSeed, aFrequency, aAmplitude);
+		break;
+	case 3:
+		solaire::_noise_accumulate<3>(aType, components, aOutput + i, aCount - i, aSeed, aFrequency, aAmplitude);
+		break;
+	case 4:
+		solaire::_noise_accumulate<4>(aType, components, aOutput + i, aCount - i, aSeed, aFrequency, aAmplitude);
+		break;
+	default:
+		break;
+	}
+}
+
+#endif
@@ -0,0 +1,172 @@
+//Copyright 2016 Adam G. Smith
+//
+//Licensed under the Apache License, Version 2.0 (the "License");
+//you may not use this file except in compliance with the License.
+//You may obtain a copy of the License at
+//
+//http ://www.apache.org/licenses/LICENSE-2.0
+//
+//Unless required by applicable law or agreed to in writing, software
+//distributed under the License is distributed on an "AS IS" BASIS,
+//WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//See the License for the specific language governing permissions and
+//limitations under the License.
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "solaire/maths/parallel.hpp"
+
+#if SOLAIRE_COMPILE_MODE != SOLAIRE_SHARED_IMPORT_COMPILE
+static std::atomic<uint32_t> THREAD_COUNT(0);
+
+namespace {
+	typedef void(*parallel_function)(const void*, const uint32_t, const uint32_t);
+
+	//! \brief Persistent workers that run one parallel_for at a time alongside the calling thread
+	class worker_pool {
+	private:
+		std::mutex mLock;
+		std::mutex mDispatch;				//!< Held by the thread that owns the current job
+		std::condition_variable mWake;
+		std::condition_variable mDone;
+		std::vector<std::thread> mWorkers;
+		std::atomic<uint32_t> mNext;		//!< Next range to claim
+		parallel_function mFunction;
+		const void* mContext;
+		uint64_t mGeneration;
+		uint32_t mCount;
+		uint32_t mChunk;
+		uint32_t mRanges;
+		uint32_t mParticipants;				//!< Workers with an index below this take part in the current job
+		uint32_t mActive;					//!< Workers that have read the current job and not yet finished it
+		bool mStop;
+
+		static thread_local bool IS_WORKER;
+	private:
+		void _run_ranges(const parallel_function aFunction, const void* const aContext, const uint32_t aCount, const uint32_t aChunk, const uint32_t aRanges) {
+			uint32_t range;
+			while((range = mNext.fetch_add(1, std::memory_order_relaxed)) < aRanges) {
+				const uint32_t begin = range * aChunk;
+				const uint32_t end = aCount - begin < aChunk ? aCount : begin + aChunk;
+				aFunction(aContext, begin, end);
+			}
+		}
+
+		void _work(const uint32_t aIndex, uint64_t aGeneration) {
+			IS_WORKER = true;
+			std::unique_lock<std::mutex> lock(mLock);
+			while(true) {
+				mWake.wait(lock, [&]() {
+					return mStop || mGeneration != aGeneration;
+				});
+				if(mStop) return;
+				aGeneration = mGeneration;
+				if(aIndex >= mParticipants) continue;
+
+				const parallel_function function = mFunction;
+				const void* const context = mContext;
+				const uint32_t count = mCount;
+				const uint32_t chunk = mChunk;
+				const uint32_t ranges = mRanges;
+				++mActive;
+				lock.unlock();
+				_run_ranges(function, context, count, chunk, ranges);
+				lock.lock();
+				if(--mActive == 0) mDone.notify_all();
+			}
+		}
+	public:
+		worker_pool() :
+			mNext(0),
+			mFunction(nullptr),
+			mContext(nullptr),
+			mGeneration(0),
+			mCount(0),
+			mChunk(0),
+			mRanges(0),
+			mParticipants(0),
+			mActive(0),
+			mStop(false)
+		{}
+
+		~worker_pool() {
+			{
+				std::lock_guard<std::mutex> lock(mLock);
+				mStop = true;
+			}
+			mWake.notify_all();
+			for(std::thread& i : mWorkers) i.join();
+		}
+
+		void run(const uint32_t aCount, const uint32_t aChunk, const uint32_t aThreads, const parallel_function aFunction, const void* const aContext) {
+			const uint32_t ranges = (aCount + aChunk - 1) / aChunk;
+			std::unique_lock<std::mutex> dispatch(mDispatch, std::try_to_lock);
+			if(IS_WORKER || ! dispatch.owns_lock() || ranges <= 1) {
+				aFunction(aContext, 0, aCount);
+				return;
+			}
+
+			{
+				std::unique_lock<std::mutex> lock(mLock);
+				// Workers only ever grow, the thread count limits how many take part
+				while(mWorkers.size() + 1 < aThreads) {
+					const uint32_t index = static_cast<uint32_t>(mWorkers.size());
+					const uint64_t generation = mGeneration;
+					mWorkers.emplace_back([this, index, generation]() {
+						_work(index, generation);
+					});
+				}
+
+				// A late worker from the previous job may still be reading mNext
+				mDone.wait(lock, [&]() {
+					return mActive == 0;
+				});
+				mFunction = aFunction;
+				mContext = aContext;
+				mCount = aCount;
+				mChunk = aChunk;
+				mRanges = ranges;
+				mParticipants = aThreads - 1;
+				mNext.store(0, std::memory_order_relaxed);
+				++mGeneration;
+			}
+			mWake.notify_all();
+
+			_run_ranges(aFunction, aContext, aCount, aChunk, ranges);
+
+			// Every range is claimed, wait for workers still running one
+			std::unique_lock<std::mutex> lock(mLock);
+			mDone.wait(lock, [&]() {
+				return mActive == 0;
+			});
+		}
+	};
+
+	thread_local bool worker_pool::IS_WORKER = false;
+
+	worker_pool& get_worker_pool() {
+		static worker_pool POOL;
+		return POOL;
+	}
+}
+
+extern "C" SOLAIRE_EXPORT_API void SOLAIRE_EXPORT_CALL solaire_set_thread_count(const uint32_t aCount) {
+	THREAD_COUNT.store(aCount, std::memory_order_relaxed);
+}
+
+extern "C" SOLAIRE_EXPORT_API uint32_t SOLAIRE_EXPORT_CALL solaire_get_thread_count() {
+	const uint32_t count = THREAD_COUNT.load(std::memory_order_relaxed);
+	if(count == 0) {
+		const uint32_t hardware = std::thread::hardware_concurrency();
+		return hardware == 0 ? 1 : hardware;
+	}
+	return count;
+}
+
+extern "C" SOLAIRE_EXPORT_API void SOLAIRE_EXPORT_CALL solaire_parallel_run(const uint32_t aCount, const uint32_t aChunk, const uint32_t aThreads, void(*aFunction)(const void*, const uint32_t, const uint32_t), const void* aContext) {
+	get_worker_pool().run(aCount, aChunk, aThreads, aFunction, aContext);
+}
+#endif
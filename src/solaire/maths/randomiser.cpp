@@ -16,24 +16,28 @@
 #include "solaire/maths/randomiser.hpp"
 
 class default_randomiser : public solaire::randomiser {
+private:
+	uint64_t mSeed;
 private:
 	// inherited from randomiser
 	double random_normal() throw() override {
-		return static_cast<double>(rand()) / static_cast<double>(RAND_MAX);
+		return static_cast<double>(rand()) / (static_cast<double>(RAND_MAX) + 1.0);
 	}
 public:
-	default_randomiser() {
-		srand(time(0));
+	default_randomiser() :
+		mSeed(static_cast<uint64_t>(time(0)))
+	{
+		srand(static_cast<unsigned int>(mSeed));
 	}
 
 	// inherited from randomiser
 	uint64_t get_seed() const throw() override {
-		//! \todo Implement default_randomiser.get_seed()
-		return 0;
+		return mSeed;
 	}
 
 	void set_seed(const uint64_t aSeed) throw() override {
-		srand(aSeed);
+		mSeed = aSeed;
+		srand(static_cast<unsigned int>(aSeed));
 	}
 
 };
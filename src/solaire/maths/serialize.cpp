@@ -0,0 +1,70 @@
+//Copyright 2016 Adam G. Smith
+//
+//Licensed under the Apache License, Version 2.0 (the "License");
+//you may not use this file except in compliance with the License.
+//You may obtain a copy of the License at
+//
+//http ://www.apache.org/licenses/LICENSE-2.0
+//
+//Unless required by applicable law or agreed to in writing, software
+//distributed under the License is distributed on an "AS IS" BASIS,
+//WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//See the License for the specific language governing permissions and
+//limitations under the License.
+
+#include "solaire/maths/serialize.hpp"
+
+#if defined(_WIN32)
+	#include <windows.h>
+#else
+	#include <fcntl.h>
+	#include <unistd.h>
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+#endif
+
+#if SOLAIRE_COMPILE_MODE != SOLAIRE_SHARED_IMPORT_COMPILE
+
+extern "C" SOLAIRE_EXPORT_API const void* SOLAIRE_EXPORT_CALL solaire_map_file(const char* aPath, uint64_t* aSize) {
+	*aSize = 0;
+	#if defined(_WIN32)
+		const HANDLE file = CreateFileA(aPath, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+		if(file == INVALID_HANDLE_VALUE) return nullptr;
+		LARGE_INTEGER size;
+		if(! GetFileSizeEx(file, &size) || size.QuadPart == 0) {
+			CloseHandle(file);
+			return nullptr;
+		}
+		const HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		CloseHandle(file);
+		if(! mapping) return nullptr;
+		const void* const view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+		CloseHandle(mapping);
+		if(! view) return nullptr;
+		*aSize = static_cast<uint64_t>(size.QuadPart);
+		return view;
+	#else
+		const int file = open(aPath, O_RDONLY);
+		if(file < 0) return nullptr;
+		struct stat info;
+		if(fstat(file, &info) != 0 || info.st_size == 0) {
+			close(file);
+			return nullptr;
+		}
+		void* const view = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_SHARED, file, 0);
+		close(file);
+		if(view == MAP_FAILED) return nullptr;
+		*aSize = static_cast<uint64_t>(info.st_size);
+		return view;
+	#endif
+}
+
+extern "C" SOLAIRE_EXPORT_API void SOLAIRE_EXPORT_CALL solaire_unmap_file(const void* aMapping, const uint64_t aSize) {
+	#if defined(_WIN32)
+		UnmapViewOfFile(aMapping);
+	#else
+		munmap(const_cast<void*>(aMapping), static_cast<size_t>(aSize));
+	#endif
+}
+
+#endif
@@ -0,0 +1,87 @@
+//Copyright 2016 Adam G. Smith
+//
+//Licensed under the Apache License, Version 2.0 (the "License");
+//you may not use this file except in compliance with the License.
+//You may obtain a copy of the License at
+//
+//http ://www.apache.org/licenses/LICENSE-2.0
+//
+//Unless required by applicable law or agreed to in writing, software
+//distributed under the License is distributed on an "AS IS" BASIS,
+//WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//See the License for the specific language governing permissions and
+//limitations under the License.
+
+#include "solaire/maths/vector.hpp"
+#include "solaire/maths/batch.hpp"
+
+#if defined(SOLAIRE_MATHS_SSE2)
+	#include <immintrin.h>
+#endif
+
+#if SOLAIRE_COMPILE_MODE != SOLAIRE_SHARED_IMPORT_COMPILE
+
+extern "C" SOLAIRE_EXPORT_API void SOLAIRE_EXPORT_CALL solaire_shuffle_bytes4(const uint8_t* aInput, uint8_t* aOutput, const uint32_t aCount, const uint8_t* aIndices) {
+	uint32_t i = 0;
+	#if defined(SOLAIRE_MATHS_SSSE3)
+		// The 4 byte pattern repeats across every 128-bit lane
+		alignas(16) uint8_t pattern[16];
+		for(uint32_t j = 0; j < 16; ++j) pattern[j] = static_cast<uint8_t>((j & ~3u) + aIndices[j & 3]);
+		const __m128i mask = _mm_load_si128(reinterpret_cast<const __m128i*>(pattern));
+		#if defined(SOLAIRE_MATHS_AVX2)
+			const __m256i mask8 = _mm256_broadcastsi128_si256(mask);
+			for(; i + 8 <= aCount; i += 8) {
+				const __m256i tmp = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(aInput + i * 4));
+				_mm256_storeu_si256(reinterpret_cast<__m256i*>(aOutput + i * 4), _mm256_shuffle_epi8(tmp, mask8));
+			}
+		#endif
+		for(; i + 4 <= aCount; i += 4) {
+			const __m128i tmp = _mm_loadu_si128(reinterpret_cast<const __m128i*>(aInput + i * 4));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(aOutput + i * 4), _mm_shuffle_epi8(tmp, mask));
+		}
+	#endif
+	for(; i < aCount; ++i) {
+		const uint8_t* const src = aInput + i * 4;
+		const uint8_t tmp[4] = { src[aIndices[0]], src[aIndices[1]], src[aIndices[2]], src[aIndices[3]] };
+		uint8_t* const dst = aOutput + i * 4;
+		dst[0] = tmp[0]; dst[1] = tmp[1]; dst[2] = tmp[2]; dst[3] = tmp[3];
+	}
+}
+
+extern "C" SOLAIRE_EXPORT_API void SOLAIRE_EXPORT_CALL solaire_distance_sq_tile(const float* aPoint, const float* aComponents, const uint32_t aStride, const uint32_t aDimensions, float* aOutput, const uint32_t aCount) {
+	// Accumulate in registers across every dimension, 8 or 4 columns at a time
+	uint32_t j = 0;
+	#if defined(SOLAIRE_MATHS_AVX)
+		for(; j + 8 <= aCount; j += 8) {
+			__m256 d = _mm256_sub_ps(_mm256_loadu_ps(aComponents + j), _mm256_set1_ps(aPoint[0]));
+			__m256 sum = _mm256_mul_ps(d, d);
+			for(uint32_t k = 1; k < aDimensions; ++k) {
+				d = _mm256_sub_ps(_mm256_loadu_ps(aComponents + k * aStride + j), _mm256_set1_ps(aPoint[k]));
+				sum = _mm256_add_ps(sum, _mm256_mul_ps(d, d));
+			}
+			_mm256_storeu_ps(aOutput + j, sum);
+		}
+	#endif
+	#if defined(SOLAIRE_MATHS_SSE2)
+		for(; j + 4 <= aCount; j += 4) {
+			__m128 d = _mm_sub_ps(_mm_loadu_ps(aComponents + j), _mm_set1_ps(aPoint[0]));
+			__m128 sum = _mm_mul_ps(d, d);
+			for(uint32_t k = 1; k < aDimensions; ++k) {
+				d = _mm_sub_ps(_mm_loadu_ps(aComponents + k * aStride + j), _mm_set1_ps(aPoint[k]));
+				sum = _mm_add_ps(sum, _mm_mul_ps(d, d));
+			}
+			_mm_storeu_ps(aOutput + j, sum);
+		}
+	#endif
+	for(; j < aCount; ++j) {
+		float d = aComponents[j] - aPoint[0];
+		float sum = d * d;
+		for(uint32_t k = 1; k < aDimensions; ++k) {
+			d = aComponents[k * aStride + j] - aPoint[k];
+			sum += d * d;
+		}
+		aOutput[j] = sum;
+	}
+}
+
+#endif
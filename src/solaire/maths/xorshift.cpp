@@ -33,4 +33,30 @@ extern "C" SOLAIRE_EXPORT_API uint64_t SOLAIRE_EXPORT_CALL solaire_xorshift_plus
 	return aSeed[1] + y;
 }
 
+extern "C" SOLAIRE_EXPORT_API void SOLAIRE_EXPORT_CALL solaire_xorshift_star_all(uint64_t* aSeed, double* aOutput, const uint32_t aCount) {
+	uint64_t x = *aSeed;
+	for(uint32_t i = 0; i < aCount; ++i) {
+		x ^= x >> 12L;
+		x ^= x << 25L;
+		x ^= x >> 27L;
+		aOutput[i] = solaire::to_normal(x * 2685821657736338717L);
+	}
+	*aSeed = x;
+}
+
+extern "C" SOLAIRE_EXPORT_API void SOLAIRE_EXPORT_CALL solaire_xorshift_plus_all(uint64_t* aSeed, double* aOutput, const uint32_t aCount) {
+	uint64_t s0 = aSeed[0];
+	uint64_t s1 = aSeed[1];
+	for(uint32_t i = 0; i < aCount; ++i) {
+		uint64_t x = s0;
+		const uint64_t y = s1;
+		s0 = y;
+		x ^= x << 23L;
+		s1 = x ^ y ^ (x >> 17L) ^ (y >> 26L);
+		aOutput[i] = solaire::to_normal(s1 + y);
+	}
+	aSeed[0] = s0;
+	aSeed[1] = s1;
+}
+
 #endif
\ No newline at end of file
@@ -0,0 +1,104 @@
+//Copyright 2016 Adam G. Smith
+//
+//Licensed under the Apache License, Version 2.0 (the "License");
+//you may not use this file except in compliance with the License.
+//You may obtain a copy of the License at
+//
+//http ://www.apache.org/licenses/LICENSE-2.0
+//
+//Unless required by applicable law or agreed to in writing, software
+//distributed under the License is distributed on an "AS IS" BASIS,
+//WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//See the License for the specific language governing permissions and
+//limitations under the License.
+
+// Checks scalar to_chars / from_chars, build with -std=c++14 for the snprintf / strto* fallback
+// and with -std=c++17 for <charconv>, both must pass the same cases
+// Returns non-zero on failure
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include "solaire/maths/format.hpp"
+
+using namespace solaire;
+
+static uint32_t FAILURES = 0;
+
+template<class T>
+static void check_parse(const char* const aText, const bool aValid, const T aExpected) {
+	T value = static_cast<T>(7);
+	const char* const end = from_chars(aText, aText + std::strlen(aText), value);
+	const bool passed = aValid ? end == aText + std::strlen(aText) && value == aExpected : end == nullptr && value == static_cast<T>(7);
+	if(! passed) {
+		std::printf("from_chars \"%s\" : expected %s\n", aText, aValid ? "success" : "failure");
+		++FAILURES;
+	}
+}
+
+template<class T>
+static void check_format(const T aValue, const char* const aExpected) {
+	char buffer[FORMAT_MAX_SCALAR + 1];
+	char* const end = to_chars(buffer, buffer + FORMAT_MAX_SCALAR, aValue);
+	if(end) *end = '\0';
+	if(end == nullptr || std::strcmp(buffer, aExpected) != 0) {
+		std::printf("to_chars : expected \"%s\", got \"%s\"\n", aExpected, end ? buffer : "nullptr");
+		++FAILURES;
+	}
+}
+
+template<class T, class I>
+static void check_round_trip(const uint32_t aCount) {
+	uint64_t state = 0x9E3779B97F4A7C15ull;
+	for(uint32_t i = 0; i < aCount; ++i) {
+		state ^= state << 13;
+		state ^= state >> 7;
+		state ^= state << 17;
+		const I bits = static_cast<I>(state);
+		T value;
+		std::memcpy(&value, &bits, sizeof(T));
+		if(value != value || value - value != static_cast<T>(0)) continue;
+
+		char buffer[FORMAT_MAX_SCALAR];
+		char* const end = to_chars(buffer, buffer + FORMAT_MAX_SCALAR, value);
+		T parsed = static_cast<T>(0);
+		if(end == nullptr || from_chars(buffer, end, parsed) != end || parsed != value) {
+			std::printf("round trip failed for %.17g\n", static_cast<double>(value));
+			++FAILURES;
+			return;
+		}
+	}
+}
+
+int main() {
+	check_parse<uint8_t>("255", true, 255);
+	check_parse<uint8_t>("300", false, 0);
+	check_parse<uint32_t>("-5", false, 0);
+	check_parse<uint32_t>("4294967295", true, 4294967295u);
+	check_parse<uint32_t>("4294967296", false, 0);
+	check_parse<uint64_t>("18446744073709551616", false, 0);
+	check_parse<int8_t>("-128", true, -128);
+	check_parse<int8_t>("-129", false, 0);
+	check_parse<int8_t>("128", false, 0);
+	check_parse<int64_t>("9223372036854775808", false, 0);
+	check_parse<float>("1.5", true, 1.5f);
+	check_parse<float>("1e50", false, 0.f);
+	check_parse<float>("1e-50", false, 0.f);
+	check_parse<float>("1e-40", true, 1e-40f);
+	check_parse<double>("1e50", true, 1e50);
+	check_parse<double>("1e400", false, 0.0);
+
+	check_format(1.5f, "1.5");
+	check_format(-0.1f, "-0.1");
+	check_format(3e10f, "3e+10");
+	check_format(0.1, "0.1");
+	check_format(1.0 / 3.0, "0.3333333333333333");
+	check_format(static_cast<uint8_t>(200), "200");
+	check_format(static_cast<int32_t>(-42), "-42");
+
+	check_round_trip<float, uint32_t>(100000);
+	check_round_trip<double, uint64_t>(100000);
+
+	std::printf("%u failures\n", FAILURES);
+	return FAILURES == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
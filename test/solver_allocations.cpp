@@ -0,0 +1,102 @@
+//Copyright 2016 Adam G. Smith
+//
+//Licensed under the Apache License, Version 2.0 (the "License");
+//you may not use this file except in compliance with the License.
+//You may obtain a copy of the License at
+//
+//http ://www.apache.org/licenses/LICENSE-2.0
+//
+//Unless required by applicable law or agreed to in writing, software
+//distributed under the License is distributed on an "AS IS" BASIS,
+//WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//See the License for the specific language governing permissions and
+//limitations under the License.
+
+// Checks that warmed up solves allocate nothing, serial or parallel
+// Returns non-zero on failure
+
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <vector>
+#include "solaire/maths/solver.hpp"
+
+static std::atomic<uint64_t> ALLOCATIONS(0);
+
+// GCC pairs the inlined replacement operators with malloc / free and warns about a mismatch that is not there
+#if defined(__GNUC__) && ! defined(__clang__) && __GNUC__ >= 11
+	#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+
+void* operator new(size_t aSize) {
+	ALLOCATIONS.fetch_add(1, std::memory_order_relaxed);
+	void* const tmp = std::malloc(aSize == 0 ? 1 : aSize);
+	if(tmp == nullptr) throw std::bad_alloc();
+	return tmp;
+}
+
+void operator delete(void* aPointer) throw() {
+	std::free(aPointer);
+}
+
+void operator delete(void* aPointer, size_t) throw() {
+	operator delete(aPointer);
+}
+
+using namespace solaire;
+
+enum : uint32_t {
+	SIZE = 200000,
+	ITERATIONS = 50
+};
+
+static bool check(const char* const aName, const csr_matrix<double>& aMatrix, const double* const aRhs, double* const aSolution, solver_workspace<double>& aWorkspace) {
+	const jacobi_preconditioner<double> preconditioner(aMatrix);
+
+	// Warm up, sizes the workspace and starts the worker threads
+	for(uint32_t i = 0; i < SIZE; ++i) aSolution[i] = 0.0;
+	conjugate_gradient(aMatrix, aRhs, aSolution, preconditioner, aWorkspace, ITERATIONS, 0.0);
+	bicgstab(aMatrix, aRhs, aSolution, preconditioner, aWorkspace, ITERATIONS, 0.0);
+
+	for(uint32_t i = 0; i < SIZE; ++i) aSolution[i] = 0.0;
+	const uint64_t before = ALLOCATIONS.load();
+	const solver_result<double> cg = conjugate_gradient(aMatrix, aRhs, aSolution, preconditioner, aWorkspace, ITERATIONS, 0.0);
+	const solver_result<double> bi = bicgstab(aMatrix, aRhs, aSolution, preconditioner, aWorkspace, ITERATIONS, 0.0);
+	const uint64_t allocations = ALLOCATIONS.load() - before;
+
+	std::printf("%s: %u + %u iterations, %llu allocations\n", aName, cg.iterations, bi.iterations, static_cast<unsigned long long>(allocations));
+	return allocations == 0;
+}
+
+int main() {
+	std::vector<sparse_entry<double>> entries;
+	entries.reserve(SIZE * 3);
+	for(uint32_t i = 0; i < SIZE; ++i) {
+		sparse_entry<double> entry;
+		entry.row = i;
+		entry.column = i;
+		entry.value = 4.0;
+		entries.push_back(entry);
+		if(i > 0) {
+			entry.column = i - 1;
+			entry.value = -1.0;
+			entries.push_back(entry);
+		}
+		if(i + 1 < SIZE) {
+			entry.column = i + 1;
+			entry.value = -1.0;
+			entries.push_back(entry);
+		}
+	}
+	const csr_matrix<double> matrix(SIZE, SIZE, entries.data(), static_cast<uint32_t>(entries.size()));
+	std::vector<double> rhs(SIZE, 1.0);
+	std::vector<double> solution(SIZE);
+
+	set_thread_count(4);
+	solver_workspace<double> serial(false);
+	solver_workspace<double> parallel(true);
+	bool passed = check("serial", matrix, rhs.data(), solution.data(), serial);
+	passed = check("parallel", matrix, rhs.data(), solution.data(), parallel) && passed;
+	return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}